@@ -1,26 +1,16 @@
 filename=`date +%Y_%m_%d`
 directory="./src/sensor_fusion"
-cd ${directory}
-if [ ! -d ${filename} ];then
-  echo ${filename}"不存在， 正在创建文件夹"
-else
-  echo "文件已存在， 将删除后重建"
-  rm -r ${filename}
-fi
-if [ ! -f ${filename}.zip ];then
-  rm -f ${filename}.zip
+# Results are written by the node into ${directory}/log as rolling .frec files
+if [ -f ${directory}/${filename}.zip ];then
+  rm -f ${directory}/${filename}.zip
   echo "压缩文件已存在，将删除后重建"
 fi
-. mkdir.sh
-
-cd ..
-cd ..
 
 source /opt/ros/dashing/setup.bash
 . install/setup.bash
 ros2 launch sensor_fusion sensor_fusion_launch.py
 cd ${directory}
-zip -r ${filename}.zip ${filename}
+zip -r ${filename}.zip log
 
 cd ..
 cd ..
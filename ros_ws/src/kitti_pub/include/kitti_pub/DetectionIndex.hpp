@@ -0,0 +1,87 @@
+#ifndef KITTI_DETECTION_INDEX_H
+#define KITTI_DETECTION_INDEX_H
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define DET_BOX_LENGTH 7
+
+/*************************************************************************
+*文件名：DetectionIndex.hpp
+*功能：一次性解析BoxInfo.txt并按帧建立索引，之后每帧的检测结果可按O(框数)取出。
+*文件每行为：帧号 中心u 中心v 宽 高（均为归一化值） ... 置信度 ... 类别
+**************************************************************************/
+struct KittiDetection {
+    int frame;
+    double box[DET_BOX_LENGTH];
+    std::string type;
+};
+
+/*****************************************************
+*功能：将归一化的检测框换算为像素坐标并截断为整数，与darknet_ros_msgs的
+*BoundingBox字段一致，kitti_pub与离线工具得到相同的检测框
+*输入：
+*img_length/img_width：图像的宽与高
+*corners：输出的xmin, ymin, xmax, ymax
+*****************************************************/
+inline void detection_pixels(const KittiDetection& det, const int img_length, const int img_width, int64_t (&corners)[4]) {
+    const double* box = det.box;
+    corners[0] = (int64_t)((box[0] - box[2] / 2) * img_length);
+    corners[1] = (int64_t)((box[1] - box[3] / 2) * img_width);
+    corners[2] = (int64_t)((box[0] + box[2] / 2) * img_length);
+    corners[3] = (int64_t)((box[1] + box[3] / 2) * img_width);
+}
+
+class DetectionIndex {
+private:
+    std::vector<KittiDetection> detections;   // sorted by frame
+    std::vector<size_t> frame_begin;          // detections of frame f are [frame_begin[f], frame_begin[f+1])
+public:
+    /*****************************************************
+    *功能：读取并解析检测文件，建立帧索引
+    *输入：
+    *file_path: BoxInfo.txt的路径
+    *输出：文件是否成功打开
+    *****************************************************/
+    bool load(const std::string& file_path) {
+        detections.clear();
+        frame_begin.clear();
+        std::ifstream input_file(file_path.c_str(), std::ifstream::in);
+        if (!input_file.is_open()) return false;
+        std::string line;
+        while (getline(input_file, line)) {
+            std::istringstream iss(line);
+            KittiDetection det;
+            if (!(iss >> det.frame) || det.frame < 0) continue;
+            for (int a = 0; a < DET_BOX_LENGTH; a++)
+                iss >> det.box[a];
+            iss >> det.type;
+            if (!iss) continue;
+            detections.push_back(det);
+        }
+        // the file is written frame by frame, stable sort keeps the per-frame order otherwise
+        std::stable_sort(detections.begin(), detections.end(),
+                         [](const KittiDetection& a, const KittiDetection& b) {return a.frame < b.frame;});
+        int max_frame = detections.empty() ? -1 : detections.back().frame;
+        frame_begin.assign(max_frame + 2, 0);
+        for (size_t i = 0; i < detections.size(); i++)
+            frame_begin[detections[i].frame + 1]++;
+        for (size_t f = 1; f < frame_begin.size(); f++)
+            frame_begin[f] += frame_begin[f - 1];
+        return true;
+    }
+    /*****************************************************
+    *功能：返回某帧的检测结果个数，first指向其中第一个
+    *****************************************************/
+    size_t getFrame(const int frame, const KittiDetection*& first) const {
+        first = nullptr;
+        if (frame < 0 || (size_t)frame + 1 >= frame_begin.size()) return 0;
+        first = detections.data() + frame_begin[frame];
+        return frame_begin[frame + 1] - frame_begin[frame];
+    }
+    size_t size() const {return detections.size();}
+};
+#endif
@@ -0,0 +1,99 @@
+#ifndef KITTI_FRAME_PREFETCHER_H
+#define KITTI_FRAME_PREFETCHER_H
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*************************************************************************
+*文件名：FramePrefetcher.hpp
+*功能：后台线程按顺序预读取之后的若干帧并存入有界环形缓冲区。
+*第s个被取出的帧存放在槽位s % capacity，工作线程最多领先消费者capacity帧，
+*消费者（发布定时器）只取出已经就绪的帧，不在定时器中做任何IO
+**************************************************************************/
+template<typename Frame>
+class FramePrefetcher {
+public:
+    // loads the frame for sequence number seq into frame, returns false when the sequence has ended
+    typedef std::function<bool(uint64_t seq, Frame& frame)> Loader;
+private:
+    enum SlotState {EMPTY, LOADING, READY, END};
+    struct Slot {
+        SlotState state;
+        Frame frame;
+    };
+    Loader loader;
+    std::vector<Slot> slots;
+    std::mutex mtx;
+    std::condition_variable cv_free;     // workers wait for a free slot
+    uint64_t next_load;                  // next sequence number claimed by a worker
+    uint64_t next_pop;                   // next sequence number handed to the consumer
+    bool stop;
+    std::vector<std::thread> workers;
+
+    void workerLoop() {
+        while (true) {
+            uint64_t seq;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                cv_free.wait(lock, [this] {return stop || next_load < next_pop + slots.size();});
+                if (stop) return;
+                seq = next_load++;
+                slots[seq % slots.size()].state = LOADING;
+            }
+            Frame frame;
+            bool ok = loader(seq, frame);
+            std::lock_guard<std::mutex> lock(mtx);
+            Slot& slot = slots[seq % slots.size()];
+            slot.frame = std::move(frame);
+            slot.state = ok ? READY : END;
+        }
+    }
+public:
+    /*****************************************************
+    *功能：初始化并启动预读取线程
+    *输入：
+    *loader_: 读取单帧的函数，会在多个工作线程中并发调用
+    *capacity: 环形缓冲区的帧数
+    *threads: 工作线程数
+    *****************************************************/
+    FramePrefetcher(const Loader& loader_, const size_t capacity, const size_t threads)
+        : loader(loader_), slots(capacity < 1 ? 1 : capacity), next_load(0), next_pop(0), stop(false) {
+        for (auto& slot : slots) slot.state = EMPTY;
+        for (size_t i = 0; i < (threads < 1 ? 1 : threads); i++)
+            workers.push_back(std::thread(&FramePrefetcher::workerLoop, this));
+    }
+    ~FramePrefetcher() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        cv_free.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+    FramePrefetcher(const FramePrefetcher&) = delete;
+    FramePrefetcher& operator = (const FramePrefetcher&) = delete;
+    /*****************************************************
+    *功能：按顺序取出下一帧，不阻塞
+    *输入：
+    *frame: 输出的帧
+    *ended: 输出序列是否已经结束
+    *输出：下一帧已就绪时返回true，尚未读完或序列结束时返回false
+    *****************************************************/
+    bool pop(Frame& frame, bool& ended) {
+        std::unique_lock<std::mutex> lock(mtx);
+        Slot& slot = slots[next_pop % slots.size()];
+        ended = slot.state == END;
+        if (slot.state != READY) return false;
+        frame = std::move(slot.frame);
+        slot.state = EMPTY;
+        next_pop++;
+        lock.unlock();
+        cv_free.notify_one();
+        return true;
+    }
+    size_t capacity() const {return slots.size();}
+};
+#endif
@@ -0,0 +1,70 @@
+#ifndef KITTI_TIMESTAMP_TABLE_H
+#define KITTI_TIMESTAMP_TABLE_H
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <builtin_interfaces/msg/time.hpp>
+
+#define STAMP_TYPES 3   // image, lidar and oxts, indexed by IMAGE/LIDAR/OXTS_
+
+/*************************************************************************
+*文件名：TimestampTable.hpp
+*功能：启动时一次性读取图像、点云与OXTS的时间戳文件并转换为ROS时间，
+*之后按帧号O(1)查询
+**************************************************************************/
+class TimestampTable {
+private:
+    std::vector<builtin_interfaces::msg::Time> stamps[STAMP_TYPES];
+public:
+    /*****************************************************
+    *功能：读取一个时间戳文件，每行对应一帧
+    *输入：
+    *type: IMAGE/LIDAR/OXTS_
+    *file_path: 时间戳文件路径
+    *输出：文件是否成功打开
+    *****************************************************/
+    bool load(const int type, const std::string& file_path) {
+        stamps[type].clear();
+        std::ifstream stp_file(file_path.c_str(), std::ifstream::in);
+        if (!stp_file.is_open()) return false;
+        std::string UTC;
+        while (getline(stp_file, UTC)) {
+            builtin_interfaces::msg::Time stamp;
+            strTime2unix(UTC, stamp);
+            stamps[type].push_back(stamp);
+        }
+        return true;
+    }
+    /*****************************************************
+    *功能：查询某帧的时间戳，帧号超出范围时返回false
+    *****************************************************/
+    bool get(const int type, const int frame, builtin_interfaces::msg::Time& stamp) const {
+        if (frame < 0 || (size_t)frame >= stamps[type].size()) return false;
+        stamp = stamps[type][frame];
+        return true;
+    }
+    size_t size(const int type) const {return stamps[type].size();}
+    /*****************************************************
+    *功能：将UTC时间转化为Unix时间戳
+    *输入：
+    *UTC: 读取的UTC时间，格式为 2011-09-26 13:02:25.964389445
+    *ros_stamp：储存转换后的时间戳
+    *****************************************************/
+    static void strTime2unix(const std::string& UTC, builtin_interfaces::msg::Time& ros_stamp) {
+        struct tm stamp;
+        memset(&stamp, 0, sizeof(tm));
+        int nanoseconds = 0;
+        sscanf(UTC.c_str(), "%d-%d-%d %d:%d:%d.%d",
+               &stamp.tm_year, &stamp.tm_mon, &stamp.tm_mday,
+               &stamp.tm_hour, &stamp.tm_min, &stamp.tm_sec, &nanoseconds);
+        stamp.tm_year -= 1900;
+        stamp.tm_mon--;
+        stamp.tm_isdst = -1;
+        ros_stamp.sec = mktime(&stamp);
+        ros_stamp.nanosec = nanoseconds;
+    }
+};
+#endif
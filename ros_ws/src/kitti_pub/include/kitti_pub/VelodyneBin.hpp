@@ -0,0 +1,41 @@
+#ifndef KITTI_VELODYNE_BIN_H
+#define KITTI_VELODYNE_BIN_H
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define VELODYNE_POINT_STEP 16   // float x, y, z, intensity
+
+/*************************************************************************
+*文件名：VelodyneBin.hpp
+*功能：将KITTI的velodyne .bin文件一次性读入连续缓冲区，不依赖ROS，
+*kitti_pub与sensor_fusion的离线工具共用。
+*.bin文件即为连续的float x,y,z,intensity，每点VELODYNE_POINT_STEP字节
+**************************************************************************/
+
+/*****************************************************
+*功能：读取velodyne .bin文件，末尾不足一个点的字节被忽略
+*输入：
+*bin_file: BIN文件名
+*data：用于储存点云的字节缓冲区，需提供resize与data
+*输出：文件是否读取成功
+*****************************************************/
+template<typename Buffer>
+inline bool read_velodyne_file(const std::string& bin_file, Buffer& data) {
+    int fd = open(bin_file.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {close(fd); return false;}
+    size_t bytes = st.st_size / VELODYNE_POINT_STEP * VELODYNE_POINT_STEP;
+    data.resize(bytes);
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t n = read(fd, reinterpret_cast<char*>(data.data()) + done, bytes - done);
+        if (n <= 0) break;
+        done += n;
+    }
+    close(fd);
+    return done == bytes;
+}
+#endif
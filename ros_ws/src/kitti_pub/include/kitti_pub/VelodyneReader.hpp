@@ -0,0 +1,46 @@
+#ifndef KITTI_VELODYNE_READER_H
+#define KITTI_VELODYNE_READER_H
+#include <string>
+#include <sensor_msgs/msg/point_cloud2.hpp>
+#include <sensor_msgs/msg/point_field.hpp>
+#include "kitti_pub/VelodyneBin.hpp"
+
+/*************************************************************************
+*文件名：VelodyneReader.hpp
+*功能：将KITTI的velodyne .bin文件一次性读入PointCloud2消息缓冲区。
+*.bin文件即为连续的float x,y,z,intensity，与消息的点布局完全一致，
+*无需逐点读取，也无需转换为pcd文件
+**************************************************************************/
+
+/*****************************************************
+*功能：设置PointCloud2的字段描述
+*****************************************************/
+inline void set_velodyne_fields(sensor_msgs::msg::PointCloud2& cloud_msg) {
+    const char* names[4] = {"x", "y", "z", "intensity"};
+    cloud_msg.fields.resize(4);
+    for (int i = 0; i < 4; i++) {
+        cloud_msg.fields[i].name = names[i];
+        cloud_msg.fields[i].offset = i * sizeof(float);
+        cloud_msg.fields[i].datatype = sensor_msgs::msg::PointField::FLOAT32;
+        cloud_msg.fields[i].count = 1;
+    }
+    cloud_msg.is_bigendian = false;
+    cloud_msg.point_step = VELODYNE_POINT_STEP;
+    cloud_msg.is_dense = true;
+}
+/*****************************************************
+*功能：读取velodyne .bin文件到点云消息
+*输入：
+*bin_file: BIN文件名
+*cloud_msg：用于储存点云的消息，header由调用者填写
+*输出：文件是否读取成功
+*****************************************************/
+inline bool read_velodyne_bin(const std::string& bin_file, sensor_msgs::msg::PointCloud2& cloud_msg) {
+    set_velodyne_fields(cloud_msg);
+    bool ok = read_velodyne_file(bin_file, cloud_msg.data);
+    cloud_msg.height = 1;
+    cloud_msg.width = cloud_msg.data.size() / VELODYNE_POINT_STEP;
+    cloud_msg.row_step = cloud_msg.data.size();
+    return ok;
+}
+#endif
@@ -2,7 +2,10 @@
 #define KITTI_DATA_UTILS_H
 
 #include <string>
+#include <memory>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <time.h>
 
@@ -14,9 +17,6 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <cv_bridge/cv_bridge.h>
 
-#include <pcl/io/pcd_io.h>
-#include <pcl_conversions/pcl_conversions.h>
-
 #include <sensor_msgs/msg/point_cloud2.hpp>
 #include <sensor_msgs/msg/image.hpp>
 #include <sensor_msgs/msg/imu.hpp>
@@ -26,18 +26,23 @@
 
 #include "darknet_ros_msgs/msg/bounding_box.hpp"
 #include "darknet_ros_msgs/msg/bounding_boxes.hpp"
+#include "kitti_pub/DetectionIndex.hpp"
+#include "kitti_pub/TimestampTable.hpp"
+#include "kitti_pub/VelodyneReader.hpp"
+#include "kitti_pub/FramePrefetcher.hpp"
 
 #define NAME_LENGTH 10
 // Timestamp in different files
 #define IMAGE 0
 #define LIDAR 1
 #define OXTS_ 2
-// Calculation of 2d-box
-#define IMG_LENGTH 1242
-#define IMG_WIDTH 375
-#define BOX_LENGTH 7
-#define FRAME_MAX 154
-#define  PUB_TIME_INTERVAL 1000ms
+#define DEFAULT_BASE_DIR "/home/kiki/data/kitti/RawData/2011_09_26/2011_09_26_drive_0005_sync"
+#define DEFAULT_FRAME_PERIOD_MS 1000  // period of a frame at rate 1.0
+#define MAX_RATE_TICK 1ms             // polling period of the max-throughput mode
+#define DEFAULT_MAX_IN_FLIGHT 2       // frames published but not yet acknowledged by sensor_fusion
+#define DEFAULT_ACK_TIMEOUT_MS 1000   // a frame without acknowledgement is given up after this
+#define PREFETCH_FRAMES 8     // frames loaded ahead of the publish timer
+#define PREFETCH_THREADS 2
 /////////////
 /// TYPES ///
 /////////////
@@ -45,10 +50,78 @@ typedef darknet_ros_msgs::msg::BoundingBox Box2d;
 typedef std::string string;
 using namespace std::chrono_literals;
 
+/*************************************************************************
+*功能：单帧KITTI数据，通过unique_ptr发布以便进程内订阅者免拷贝接收
+*************************************************************************/
+struct KittiFrame {
+    int index;
+    std::unique_ptr<sensor_msgs::msg::Image> img_msg;
+    std::unique_ptr<sensor_msgs::msg::PointCloud2> cloud_msg;
+    std::unique_ptr<darknet_ros_msgs::msg::BoundingBoxes> box_msg;
+    std::unique_ptr<darknet_ros_msgs::msg::BoundingBoxes> obj_msg;
+};
+
+/*************************************************************************
+*功能：KITTI数据集的只读访问。索引与时间戳在load时一次性读入，
+*之后各读取函数只依赖帧号，可在多个线程中并发调用
+*************************************************************************/
+class KittiDataset {
+private:
+    string base_dir;
+    const string img_dir = "/image_02/data/";
+    const string oxt_dir = "/oxts/data/";
+    const string det_dir = "/image_02/BoxInfo.txt";
+    const string img_stp = "/image_02/timestamps.txt";
+    const string pcl_stp = "/velodyne_points/timestamps.txt";
+    const string oxt_stp = "/oxts/timestamps.txt";
+    const string bin_dir = "/velodyne_points/data/";
+    rclcpp::Logger logger;
+    DetectionIndex detIndex;
+    TimestampTable stpTable;
+    struct dynamics {
+        float vn, ve, vf, vl, vu;
+        float ax, ay, az;
+        float wx, wy, wz;
+        float pos_accuracy, vel_accuracy;
+        int numstats, posmode, velmode, orimode;
+    };
+    string nameGenerate(const int frame, const string& suffix, const int length = NAME_LENGTH) const;
+public:
+    KittiDataset() : logger(rclcpp::get_logger("kitti_dataset")) {}
+    bool load(const string& base_dir_);
+    void read_stp(std_msgs::msg::Header& header, int type, const int frame) const;
+    void read_img(const int frame, sensor_msgs::msg::Image& img_msg) const;
+    void read_pcl(const int frame, sensor_msgs::msg::PointCloud2& cloud_msg) const;
+    void read_oxt(const int frame, sensor_msgs::msg::Imu::SharedPtr& imu,
+                  sensor_msgs::msg::NavSatFix::SharedPtr& gps) const;
+    // void read_oxt(nav_msgs::msg::Odometry::SharedPtr& odom);
+    void read_det(const int frame, const int img_length, const int img_width,
+                  darknet_ros_msgs::msg::BoundingBoxes& boundingBoxes_msg,
+                  darknet_ros_msgs::msg::BoundingBoxes& objections_msg) const;
+    bool load_frame(const int frame, KittiFrame& kitti_frame) const;
+    size_t size() const {return stpTable.size(LIDAR);}
+};
+
+/*************************************************************************
+*功能：KITTI回放节点。参数：
+*base_dir: 数据集（单个drive）的根目录
+*start_frame/end_frame: 回放的帧范围（闭区间），end_frame为负时回放到最后一帧
+*frame_period_ms: 倍速为1时的帧间隔
+*rate: 回放倍速；不大于0时以最大吞吐量回放，由ack_topic上sensor_fusion的
+*     完成确认限制未确认帧数不超过max_in_flight，超时ack_timeout_ms后不再等待
+*loop: 回放到end_frame后是否从start_frame重新开始
+*************************************************************************/
 class KittiPublisher : public rclcpp::Node {
 private:
-    int frame;
+    int start_frame;
+    int end_frame;
+    bool loop;
+    bool max_throughput;
+    int max_in_flight;
+    std::chrono::milliseconds ack_timeout;
     size_t count_;
+    std::atomic<int> in_flight;
+    std::chrono::steady_clock::time_point last_publish;
     rclcpp::TimerBase::SharedPtr timer_;
     rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr img_pub;
     rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pcl_pub;
@@ -57,124 +130,193 @@ private:
     // rclcpp::Publisher<nav_msgs::msg::Odometry>::SharedPtr odom_pub;
     rclcpp::Publisher<darknet_ros_msgs::msg::BoundingBoxes>::SharedPtr box2d_pub;
     rclcpp::Publisher<darknet_ros_msgs::msg::BoundingBoxes>::SharedPtr obj2d_pub;
-    struct dynamics {
-        float vn, ve, vf, vl, vu;
-        float ax, ay, az;
-        float wx, wy, wz;
-        float pos_accuracy, vel_accuracy;
-        int numstats, posmode, velmode, orimode;
-    };
+    rclcpp::Subscription<std_msgs::msg::Header>::SharedPtr ack_sub;
+    KittiDataset dataset;
+    std::unique_ptr<FramePrefetcher<KittiFrame>> prefetcher;
+    // the timer only publishes frames the prefetcher has already loaded, it does no IO itself
     void timer_callback() {
-        pcl::PointCloud<pcl::PointXYZI>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZI>);
-        if(frame < FRAME_MAX) {
-        sensor_msgs::msg::Image::SharedPtr img_msg;
-        sensor_msgs::msg::Imu::SharedPtr imu_msg;
-        sensor_msgs::msg::NavSatFix::SharedPtr gps_msg;
-        darknet_ros_msgs::msg::BoundingBoxes bBoxes_msg;
-        darknet_ros_msgs::msg::BoundingBoxes obj_msg;
-        read_pcl(cloud);
-        read_img(img_msg);
-        //read_oxt(imu_msg, gps_msg);
-        read_det(bBoxes_msg, obj_msg);
-
-        img_pub->publish(*img_msg);
+        if (max_throughput && in_flight >= max_in_flight) {
+            if (std::chrono::steady_clock::now() - last_publish < ack_timeout) return;
+            in_flight = 0;
+        }
+        KittiFrame kitti_frame;
+        bool ended;
+        if (!prefetcher->pop(kitti_frame, ended)) {
+            if (ended) {
+                RCLCPP_INFO(this->get_logger(), "Replay finished after %zu frames.", count_);
+                timer_->cancel();
+            } else if (!max_throughput) {
+                RCLCPP_WARN(this->get_logger(), "Next frame is not loaded yet, skipping this tick.");
+            }
+            return;
+        }
+        img_pub->publish(std::move(kitti_frame.img_msg));
         //imu_pub->publish(*imu_msg);
         //gps_pub->publish(*gps_msg);
-        box2d_pub->publish(bBoxes_msg);
-        obj2d_pub->publish(obj_msg);
-        publish_point_cloud(cloud);
-        frame += 1;
-        frame %= FRAME_MAX;
-        RCLCPP_INFO(this->get_logger(), "Publishing frame: %d", frame);}
+        box2d_pub->publish(std::move(kitti_frame.box_msg));
+        obj2d_pub->publish(std::move(kitti_frame.obj_msg));
+        pcl_pub->publish(std::move(kitti_frame.cloud_msg));
+        in_flight++;
+        last_publish = std::chrono::steady_clock::now();
+        count_++;
+        RCLCPP_INFO(this->get_logger(), "Publishing frame: %d", kitti_frame.index);
+    }
+    void ack_callback(const std_msgs::msg::Header::SharedPtr) {
+        if (in_flight > 0) in_flight--;
+    }
+    /*****************************************************
+    *功能：将预读取的序号映射为帧号，非循环回放时超出范围返回false
+    *****************************************************/
+    bool frame_of(const uint64_t seq, int& frame) const {
+        uint64_t frames = end_frame - start_frame + 1;
+        if (!loop && seq >= frames) return false;
+        frame = start_frame + seq % frames;
+        return true;
     }
-    const string base_dir = "/home/kiki/data/kitti/RawData/2011_09_26/2011_09_26_drive_0005_sync";
-    const string img_dir = "/image_02/data/";
-    const string oxt_dir = "/oxts/data/";
-    const string det_dir = "/image_02/BoxInfo.txt";
-    const string img_stp = "/image_02/timestamps.txt";
-    const string pcl_stp = "/velodyne_points/timestamps.txt";
-    const string oxt_stp = "/oxts/timestamps.txt";
-    const string pcd_dir = "/velodyne_points/pcd/";
-    const string bin_dir = "/velodyne_points/data/";
-
-    void read_stp(std_msgs::msg::Header& header, int type);
-    void read_img(sensor_msgs::msg::Image::SharedPtr& img_msg);
-    void read_pcl(pcl::PointCloud<pcl::PointXYZI>::Ptr& cloud);
-    void read_oxt(sensor_msgs::msg::Imu::SharedPtr& imu,
-                                  sensor_msgs::msg::NavSatFix::SharedPtr& gps);
-    // void read_oxt(nav_msgs::msg::Odometry::SharedPtr& odom);
-    void read_det(darknet_ros_msgs::msg::BoundingBoxes& boundingBoxes_msg, darknet_ros_msgs::msg::BoundingBoxes& objections_msg);
-    void publish_point_cloud(pcl::PointCloud<pcl::PointXYZI>::Ptr cloud);
-    void kittiBin2Pcd(string &in_file, string& out_file);
-    void strTime2unix(string UTC, int& seconds, int& nanoseconds);
-    string nameGenerate(const string& suffix, const int length = NAME_LENGTH);
 public:
-    KittiPublisher():Node("kitti_node") ,frame(135), count_(0) {
+    explicit KittiPublisher(const rclcpp::NodeOptions& options = rclcpp::NodeOptions())
+        : Node("kitti_node", options), count_(0), in_flight(0) {
         img_pub = this->create_publisher<sensor_msgs::msg::Image>("kitti_cam02", 10);
         pcl_pub = this->create_publisher<sensor_msgs::msg::PointCloud2>("kitti_points", 10);
         imu_pub = this->create_publisher<sensor_msgs::msg::Imu>("kitti_imu", 10);
         gps_pub = this->create_publisher<sensor_msgs::msg::NavSatFix>("kitti_gps", 10);
         box2d_pub = this->create_publisher<darknet_ros_msgs::msg::BoundingBoxes>("yolo_det", 10);
         obj2d_pub = this->create_publisher<darknet_ros_msgs::msg::BoundingBoxes>("obj_det", 10);
-        timer_ = this->create_wall_timer(
-        PUB_TIME_INTERVAL, std::bind(&KittiPublisher::timer_callback, this));
+
+        // Replay parameters
+        string base_dir, ack_topic;
+        int frame_period_ms, ack_timeout_ms;
+        double rate;
+        this->declare_parameter<string>("base_dir", DEFAULT_BASE_DIR);
+        this->declare_parameter<int>("start_frame", 0);
+        this->declare_parameter<int>("end_frame", -1);
+        this->declare_parameter<int>("frame_period_ms", DEFAULT_FRAME_PERIOD_MS);
+        this->declare_parameter<double>("rate", 1.0);
+        this->declare_parameter<bool>("loop", true);
+        this->declare_parameter<string>("ack_topic", "/sensor_fusion/frame_done");
+        this->declare_parameter<int>("max_in_flight", DEFAULT_MAX_IN_FLIGHT);
+        this->declare_parameter<int>("ack_timeout_ms", DEFAULT_ACK_TIMEOUT_MS);
+        this->get_parameter_or<string>("base_dir", base_dir, DEFAULT_BASE_DIR);
+        this->get_parameter_or<int>("start_frame", start_frame, 0);
+        this->get_parameter_or<int>("end_frame", end_frame, -1);
+        this->get_parameter_or<int>("frame_period_ms", frame_period_ms, DEFAULT_FRAME_PERIOD_MS);
+        this->get_parameter_or<double>("rate", rate, 1.0);
+        this->get_parameter_or<bool>("loop", loop, true);
+        this->get_parameter_or<string>("ack_topic", ack_topic, "/sensor_fusion/frame_done");
+        this->get_parameter_or<int>("max_in_flight", max_in_flight, DEFAULT_MAX_IN_FLIGHT);
+        this->get_parameter_or<int>("ack_timeout_ms", ack_timeout_ms, DEFAULT_ACK_TIMEOUT_MS);
+        max_throughput = rate <= 0;
+        max_in_flight = std::max(max_in_flight, 1);
+        ack_timeout = std::chrono::milliseconds(ack_timeout_ms);
+
+        if (!dataset.load(base_dir)) {
+            RCLCPP_ERROR(this->get_logger(), "Couldn't load %s, nothing to replay.", base_dir.c_str());
+            return;
+        }
+        int last_frame = (int)dataset.size() - 1;
+        if (end_frame < 0 || end_frame > last_frame) end_frame = last_frame;
+        start_frame = std::max(start_frame, 0);
+        if (start_frame > end_frame) {
+            RCLCPP_ERROR(this->get_logger(), "Empty frame range [%d, %d], nothing to replay.", start_frame, end_frame);
+            return;
+        }
+        prefetcher.reset(new FramePrefetcher<KittiFrame>(
+            [this](uint64_t seq, KittiFrame& kitti_frame) {
+                int frame;
+                return frame_of(seq, frame) && dataset.load_frame(frame, kitti_frame);
+            }, PREFETCH_FRAMES, PREFETCH_THREADS));
+
+        if (max_throughput) {
+            ack_sub = this->create_subscription<std_msgs::msg::Header>(ack_topic, 10,
+                std::bind(&KittiPublisher::ack_callback, this, std::placeholders::_1));
+            timer_ = this->create_wall_timer(MAX_RATE_TICK, std::bind(&KittiPublisher::timer_callback, this));
+        } else {
+            std::chrono::microseconds period((int64_t)(frame_period_ms * 1000.0 / rate));
+            timer_ = this->create_wall_timer(period, std::bind(&KittiPublisher::timer_callback, this));
+        }
+        string speed = max_throughput ? "max throughput" : std::to_string(rate) + "x";
+        RCLCPP_INFO(this->get_logger(), "Replaying frames [%d, %d] of %s at %s%s.", start_frame, end_frame,
+                    base_dir.c_str(), speed.c_str(), loop ? ", looping" : "");
     }
 };
 
 /*****************************************************
-*功能：读取对应帧的时间并转换为unix时间戳
+*功能：读取检测索引与时间戳表
 *输入：
-*type: 可按需读取图像，点云，OXT（IMU&GPS）的时间戳
+*base_dir_: 数据集（单个drive）的根目录
+*输出：点云时间戳是否读取成功。帧数由点云时间戳决定，缺失时无法回放；
+*检测、图像与OXTS时间戳缺失时只影响对应的消息
 *****************************************************/
-void KittiPublisher::read_stp(std_msgs::msg::Header& header, int type) {
-    string stp_path = "";
-    switch (type){
-        case IMAGE : stp_path = base_dir + img_stp; break;
-        case LIDAR : stp_path = base_dir + pcl_stp; break;
-        case OXTS_ : stp_path = base_dir + oxt_stp; break;
-    }
-    int count_skip = frame + 1;
-    std::ifstream stp_file(stp_path.c_str(), std::ifstream::in);
-    if(!stp_file.is_open()) PCL_ERROR ("Timestamp File doesn't exist.");
-    else {
-        string UTC = "";
-        while (count_skip--) getline(stp_file, UTC);
-        int seconds;
-        int nanoseconds;
-        strTime2unix(UTC, seconds, nanoseconds);
-        //header.seq = frame;
-        header.stamp.sec = seconds;
-        header.stamp.nanosec = nanoseconds;
-        header.frame_id = "map";
+bool KittiDataset::load(const string& base_dir_) {
+    base_dir = base_dir_;
+    if (!detIndex.load(base_dir + det_dir))
+        RCLCPP_WARN(logger, "Detection File %s doesn't exist.", (base_dir + det_dir).c_str());
+    if (!stpTable.load(IMAGE, base_dir + img_stp))
+        RCLCPP_WARN(logger, "Image Timestamp File %s doesn't exist.", (base_dir + img_stp).c_str());
+    if (!stpTable.load(OXTS_, base_dir + oxt_stp))
+        RCLCPP_WARN(logger, "Oxts Timestamp File %s doesn't exist.", (base_dir + oxt_stp).c_str());
+    if (!stpTable.load(LIDAR, base_dir + pcl_stp)) {
+        RCLCPP_ERROR(logger, "Pointcloud Timestamp File %s doesn't exist.", (base_dir + pcl_stp).c_str());
+        return false;
     }
+    return true;
+}
+/*****************************************************
+*功能：读取并解码一帧的图像、点云与检测结果，不依赖节点状态
+*输入：
+*frame: 帧号
+*kitti_frame: 输出的单帧数据
+*输出：帧号是否在数据集范围内
+*****************************************************/
+bool KittiDataset::load_frame(const int frame, KittiFrame& kitti_frame) const {
+    if (frame < 0 || (size_t)frame >= stpTable.size(LIDAR)) return false;
+    kitti_frame.index = frame;
+    kitti_frame.img_msg.reset(new sensor_msgs::msg::Image);
+    kitti_frame.cloud_msg.reset(new sensor_msgs::msg::PointCloud2);
+    kitti_frame.box_msg.reset(new darknet_ros_msgs::msg::BoundingBoxes);
+    kitti_frame.obj_msg.reset(new darknet_ros_msgs::msg::BoundingBoxes);
+    read_pcl(frame, *kitti_frame.cloud_msg);
+    read_img(frame, *kitti_frame.img_msg);
+    //read_oxt(frame, imu_msg, gps_msg);
+    // the detections are normalised by the image size, without an image they can't be placed
+    if (kitti_frame.img_msg->width == 0 || kitti_frame.img_msg->height == 0)
+        RCLCPP_WARN(logger, "Image of frame %d is empty, its detections are skipped.", frame);
+    read_det(frame, kitti_frame.img_msg->width, kitti_frame.img_msg->height, *kitti_frame.box_msg, *kitti_frame.obj_msg);
+    return true;
+}
+/*****************************************************
+*功能：从预先加载的时间戳表中取出对应帧的unix时间戳
+*输入：
+*type: 可按需读取图像，点云，OXT（IMU&GPS）的时间戳
+*****************************************************/
+void KittiDataset::read_stp(std_msgs::msg::Header& header, int type, const int frame) const {
+    if (!stpTable.get(type, frame, header.stamp))
+        RCLCPP_INFO(logger, "No timestamp for frame %d.", frame);
+    //header.seq = frame;
+    header.frame_id = "map";
 }
 /*****************************************************
 *功能：使用OpenCv读取图像并转换为ROS消息格式
 *输入：
-*img_msg：ROS格式的图像
+*img_msg：用于储存ROS格式的图像
 *****************************************************/
-void KittiPublisher::read_img(sensor_msgs::msg::Image::SharedPtr& img_msg) {
-    string img_file = base_dir + img_dir + nameGenerate("png");
+void KittiDataset::read_img(const int frame, sensor_msgs::msg::Image& img_msg) const {
+    string img_file = base_dir + img_dir + nameGenerate(frame, "png");
     cv::Mat image = cv::imread(img_file, CV_LOAD_IMAGE_COLOR);
     std_msgs::msg::Header header;
-    read_stp(header, IMAGE);
-    img_msg = cv_bridge::CvImage(header, "bgr8", image).toImageMsg();
+    read_stp(header, IMAGE, frame);
+    cv_bridge::CvImage(header, "bgr8", image).toImageMsg(img_msg);
 }
 /*****************************************************
-*功能：从pcd文件中读取点云数据并转化为PCL的点云格式
+*功能：直接读取velodyne的bin文件到ROS点云消息
 *输入：
-*cloud：ROS格式的点云，包含三维坐标系与点云强度
+*cloud_msg：ROS格式的点云，包含三维坐标系与点云强度
 *****************************************************/
-void KittiPublisher::read_pcl(pcl::PointCloud<pcl::PointXYZI>::Ptr& cloud) {
-    string pcd_file = base_dir + pcd_dir + nameGenerate("pcd");
-    if (access(pcd_file.c_str(), 0) == -1) {
-        RCLCPP_INFO(this->get_logger(), "Transferring binary files into pcd files.");
-        string bin_file = base_dir + bin_dir + nameGenerate("bin");
-        kittiBin2Pcd(bin_file, pcd_file);
-    }
-    if (pcl::io::loadPCDFile<pcl::PointXYZI> (pcd_file, *cloud) == -1) {
-        PCL_ERROR ("File doesn't exist.");
-    }
+void KittiDataset::read_pcl(const int frame, sensor_msgs::msg::PointCloud2& cloud_msg) const {
+    string bin_file = base_dir + bin_dir + nameGenerate(frame, "bin");
+    if (!read_velodyne_bin(bin_file, cloud_msg))
+        RCLCPP_INFO(logger, "Couldn't read binary files of pointcloud.");
+    read_stp(cloud_msg.header, LIDAR, frame);
 }
 /*****************************************************
 *功能：读取IMU和GPS数据
@@ -182,11 +324,11 @@ void KittiPublisher::read_pcl(pcl::PointCloud<pcl::PointXYZI>::Ptr& cloud) {
 *imu_msg：ROS格式的IMU数据
 *gps_msg：ROS格式的GPS数据
 *****************************************************/
-void KittiPublisher::read_oxt(sensor_msgs::msg::Imu::SharedPtr& imu,
-                              sensor_msgs::msg::NavSatFix::SharedPtr& gps) {
-    string oxt_path = base_dir + oxt_dir + nameGenerate("txt");
+void KittiDataset::read_oxt(const int frame, sensor_msgs::msg::Imu::SharedPtr& imu,
+                            sensor_msgs::msg::NavSatFix::SharedPtr& gps) const {
+    string oxt_path = base_dir + oxt_dir + nameGenerate(frame, "txt");
     std::ifstream oxt_file(oxt_path.c_str(), std::ifstream::in);
-    if(!oxt_file.is_open()) RCLCPP_INFO (this->get_logger(), "Oxts File doesn't exist.");
+    if(!oxt_file.is_open()) RCLCPP_INFO (logger, "Oxts File doesn't exist.");
     else {
 
         string line;
@@ -195,7 +337,7 @@ void KittiPublisher::read_oxt(sensor_msgs::msg::Imu::SharedPtr& imu,
         for (size_t i = 0; i < line.length(); i++) tmp[i] = line[i];
         dynamics dym;
         double roll, pitch, yaw;
-        std::cout << line << std::endl;
+        RCLCPP_DEBUG(logger, "Oxts of frame %d: %s", frame, line.c_str());
 
         sscanf(tmp, "%lf %lf %lf %lf %lf %lf %f %f %f %f %f %f %f %f %lf %lf %lf %f %f %f %lf %lf %lf %f %f %c %d %d %d %d", 
         &gps->latitude, &gps->longitude, &gps->altitude,
@@ -208,118 +350,64 @@ void KittiPublisher::read_oxt(sensor_msgs::msg::Imu::SharedPtr& imu,
         &dym.pos_accuracy, &dym.vel_accuracy, &gps->status.status, &dym.numstats, 
         &dym.posmode, &dym.velmode, &dym.orimode);
 
-        std::cout << "done filling." << std::endl;
         //gps.position_covariance_type = COVARIANCE_TYPE_UNKNOWN;
         //EulertoQuaternion(angle, imu.orientation);
         tf2::Quaternion quat_tf;
         quat_tf.setRPY(roll, pitch, yaw);
         imu->orientation = tf2::toMsg(quat_tf);
-        std::cout << "header." << std::endl;
         std_msgs::msg::Header header;
-        read_stp(header, OXTS_);
+        read_stp(header, OXTS_, frame);
         gps->header = header;
         imu->header = header;
     }
-    std::cout << "done oxt." << std::endl;
     oxt_file.close();
 }
 /*****************************************************
-*功能：读取图像识别二维检测结果
+*功能：从启动时建立的检测索引中取出对应帧的二维检测结果
 *输入：
+*img_length/img_width：对应图像的宽与高，检测结果为归一化坐标；为0时不输出检测结果
 *boundingBoxes_msg：单帧检测结果的消息
 *****************************************************/
-void KittiPublisher::read_det(darknet_ros_msgs::msg::BoundingBoxes& boundingBoxes_msg, darknet_ros_msgs::msg::BoundingBoxes& objections_msg) {
-    string file_path = base_dir + det_dir;
-    std::ifstream input_file(file_path.c_str(), std::ifstream::in);
-    if(!input_file.is_open()) RCLCPP_INFO (this->get_logger(), "Detection File doesn't exist.");
-    string line;
-    int frame_read;
+void KittiDataset::read_det(const int frame, const int img_length, const int img_width,
+                            darknet_ros_msgs::msg::BoundingBoxes& boundingBoxes_msg,
+                            darknet_ros_msgs::msg::BoundingBoxes& objections_msg) const {
+    const KittiDetection* det = nullptr;
+    size_t det_count = img_length > 0 && img_width > 0 ? detIndex.getFrame(frame, det) : 0;
+    boundingBoxes_msg.bounding_boxes.reserve(det_count);
+    objections_msg.bounding_boxes.reserve(det_count);
     int id = 0;
-    while(getline(input_file, line)) {
-        std::istringstream iss(line);
-        iss >> frame_read;
-        if (frame_read == frame) {
-            double box[BOX_LENGTH];
-            string type;
-            for (int a = 0; a < BOX_LENGTH; a++)
-                iss >> box[a];
-            iss >> type;
-            Box2d boundingBox;
-            double xmin = (box[0] - box[2] / 2) * IMG_LENGTH;
-            double ymin = (box[1] - box[3] / 2) * IMG_WIDTH;
-            double xmax = (box[0] + box[2] / 2) * IMG_LENGTH;
-            double ymax = (box[1] + box[3] / 2) * IMG_WIDTH;
-            boundingBox.obj_class = type;
-            boundingBox.probability = box[5];
-            boundingBox.xmin = xmin;
-            boundingBox.ymin = ymin;
-            boundingBox.xmax = xmax;
-            boundingBox.ymax = ymax;
-            if (type == "car" || type == "truck") {
-                boundingBox.id = id;
-                boundingBoxes_msg.bounding_boxes.push_back(boundingBox);
-                id++;
-            } else {
-                boundingBox.id = -1;
-                objections_msg.bounding_boxes.push_back(boundingBox);
-            }
+    for (size_t i = 0; i < det_count; i++, det++) {
+        Box2d boundingBox;
+        int64_t corners[4];
+        detection_pixels(*det, img_length, img_width, corners);
+        boundingBox.obj_class = det->type;
+        boundingBox.probability = det->box[5];
+        boundingBox.xmin = corners[0];
+        boundingBox.ymin = corners[1];
+        boundingBox.xmax = corners[2];
+        boundingBox.ymax = corners[3];
+        if (det->type == "car" || det->type == "truck") {
+            boundingBox.id = id;
+            boundingBoxes_msg.bounding_boxes.push_back(boundingBox);
+            id++;
+        } else {
+            boundingBox.id = -1;
+            objections_msg.bounding_boxes.push_back(boundingBox);
         }
-        else if(frame_read > frame)
-            break;
     }
     std_msgs::msg::Header header;
-    read_stp(header, IMAGE);
+    read_stp(header, IMAGE, frame);
     boundingBoxes_msg.header = header;
     boundingBoxes_msg.image_header = header;
     objections_msg.header = header;
     objections_msg.image_header = header;
-    input_file.close();
-}
-/*****************************************************
-*功能：PCL格式点云转换为ros_msg格式点云并发布
-*输入：
-*cloud: 指向pcl格式点云的指针
-*****************************************************/
-void KittiPublisher::publish_point_cloud(pcl::PointCloud<pcl::PointXYZI>::Ptr cloud) {
-    sensor_msgs::msg::PointCloud2 cloud_msg;
-    pcl::toROSMsg(*cloud, cloud_msg);
-    std_msgs::msg::Header header;
-    read_stp(header, LIDAR);
-    cloud_msg.header = header;
-    pcl_pub->publish(cloud_msg);
-}
-/*****************************************************
-*功能：转换bin格式文件为pcd
-*输入：
-*in_file: BIN文件名
-*out_file：PCD文件名
-*****************************************************/
-void KittiPublisher::kittiBin2Pcd(string &in_file, string& out_file) {
-    // 读取二进制文件
-    std::fstream input(in_file.c_str(), std::ios::in | std::ios::binary);
-    if(!input.good()){
-        PCL_ERROR ("Couldn't read binary files of pointcloud.");
-        exit(EXIT_FAILURE);
-    }
-    // 定位到开始
-    input.seekg(0, std::ios::beg);
-    pcl::PointCloud<pcl::PointXYZI>::Ptr points (new pcl::PointCloud<pcl::PointXYZI>);
-    for (int i = 0; input.good() && !input.eof(); i++) {
-        pcl::PointXYZI point;
-        input.read((char *) &point.x, 3*sizeof(float));
-        input.read((char *) &point.intensity, sizeof(float));
-        points->push_back(point);
-    }
-    input.close();
-    pcl::PCDWriter writer;
-    writer.write<pcl::PointXYZI> (out_file, *points, false);
 }
 /*****************************************************
 *功能：生成文件名
 *输入：
-*suffix：文件后缀，用到的后缀有png/bin/pcd
+*suffix：文件后缀，用到的后缀有png/bin
 *****************************************************/
-string KittiPublisher::nameGenerate(const string& suffix, const int length) {
+string KittiDataset::nameGenerate(const int frame, const string& suffix, const int length) const {
     string file_name = std::to_string(frame);
     int cur_length = length-file_name.size();
     for (int a = 0; a < cur_length; a++)
@@ -328,24 +416,5 @@ string KittiPublisher::nameGenerate(const string& suffix, const int length) {
     file_name += suffix;
     return file_name;
 }
-/*****************************************************
-*功能：将UTC时间转化为Unix时间戳
-*输入：
-*UTC: 读取的UTC时间
-*ros_stamp：储存转换后的时间戳
-*****************************************************/
-void KittiPublisher::strTime2unix(string UTC, int& seconds, int& nanoseconds) {
-    struct tm stamp;
-    //memset(&ros_stamp, 0, sizeof(tm));
-    char tmp[28] = {0};
-    for (size_t i = 0; i < UTC.length(); i++) tmp[i] = UTC[i];
-    sscanf(tmp, "%d-%d-%d %d:%d:%d.%d", 
-           &stamp.tm_year, &stamp.tm_mon, &stamp.tm_mday,
-           &stamp.tm_hour, &stamp.tm_min, &stamp.tm_sec, &nanoseconds);
-    stamp.tm_year -= 1900;
-    stamp.tm_mon--;
-    seconds = mktime(&stamp);
-}
-
 
 #endif
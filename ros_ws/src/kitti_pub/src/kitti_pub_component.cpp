@@ -0,0 +1,4 @@
+#include "kitti_pub/kitti_data_utils.hpp"
+#include <rclcpp_components/register_node_macro.hpp>
+// Register KittiPublisher so that it can be loaded into a component container
+RCLCPP_COMPONENTS_REGISTER_NODE(KittiPublisher)
@@ -0,0 +1,371 @@
+/*************************************************************************
+*文件名：fusion_benchmark.cpp
+*功能：融合算法核心函数的Google Benchmark基准测试，按点云规模与检测框数量参数化。
+*合成场景为地面加若干车辆（尾部与侧面），二维检测框由车辆角点投影得到；
+*设置环境变量SENSOR_FUSION_BENCH_BIN为KITTI velodyne .bin文件时，另外测试实录点云
+*用法：
+*colcon build --cmake-args -DBUILD_BENCHMARKS=ON
+*fusion_benchmark --benchmark_filter=GroundRemove
+**************************************************************************/
+#include "sensor_fusion/GroundRemove.h"
+#include "sensor_fusion/detection_fusion.h"
+#include "sensor_fusion/Tracking.h"
+#include "kitti_pub/VelodyneBin.hpp"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+#define BENCH_GROUND_Z (-1.73)
+#define BENCH_CAR_POINTS 400
+#define BENCH_CAR_LENGTH 4.0
+#define BENCH_CAR_WIDTH 1.7
+#define BENCH_CAR_HEIGHT 1.5
+
+/*************************************************************************
+*功能：合成的单帧场景及其标定参数（KITTI 2011_09_26）
+*************************************************************************/
+struct SyntheticScene {
+    Matrix34d P;
+    Matrix3d R;
+    Matrix31d T;
+    pcl::PointCloud<pcl::PointXYZI>::Ptr cloud;
+    Boxes2d det_boxes;
+    Boxes2d obj_boxes;
+
+    SyntheticScene(const size_t points, const size_t cars, const unsigned seed = 42)
+        : cloud(new pcl::PointCloud<pcl::PointXYZI>) {
+        P << 721.5377, 0, 609.5593, 44.85728,
+             0, 721.5377, 172.854, 0.2163791,
+             0, 0, 1, 0.002745884;
+        R << 7.533745e-03, -9.999714e-01, -6.166020e-04,
+             1.480249e-02, 7.280733e-04, -9.998902e-01,
+             9.998621e-01, 7.523790e-03, 1.480755e-02;
+        T << -4.069766e-03, -7.631618e-02, -2.717806e-01;
+        std::mt19937 rng(seed);
+        for (size_t k = 0; k < cars; k++) addCar(8 + 5.0 * k, ((int)(k % 3) - 1) * 3.5, rng);
+        addGround(points > cloud->points.size() ? points - cloud->points.size() : 0, rng);
+        cloud->width = cloud->points.size();
+        cloud->height = 1;
+    }
+    /*****************************************************
+    *功能：车辆可见的尾部与侧面点云，以及投影得到的二维检测框
+    *****************************************************/
+    void addCar(const double cx, const double cy, std::mt19937& rng) {
+        std::uniform_real_distribution<float> unit(0, 1), intensity(10, 40);
+        double x0 = cx - BENCH_CAR_LENGTH / 2;
+        double side = cy > 0 ? cy - BENCH_CAR_WIDTH / 2 : cy + BENCH_CAR_WIDTH / 2;
+        for (int i = 0; i < BENCH_CAR_POINTS; i++) {
+            pcl::PointXYZI p;
+            p.z = BENCH_GROUND_Z + 0.2 + unit(rng) * (BENCH_CAR_HEIGHT - 0.2);
+            p.intensity = intensity(rng);
+            if (i % 2 || cy == 0) {
+                p.x = x0;
+                p.y = cy + (unit(rng) - 0.5) * BENCH_CAR_WIDTH;
+            } else {
+                p.x = x0 + unit(rng) * BENCH_CAR_LENGTH;
+                p.y = side;
+            }
+            cloud->points.push_back(p);
+        }
+        Matrix4d spatial_trans = Matrix4d::Identity();
+        spatial_trans.block<3,3>(0,0) = R;
+        spatial_trans.block<3,1>(0,3) = T;
+        Matrix34d projection = P * spatial_trans;
+        double umin = KittiRig::img_length, vmin = KittiRig::img_width, umax = 0, vmax = 0;
+        for (int c = 0; c < 8; c++) {
+            Eigen::Vector4d corner(cx + ((c & 1) ? 0.5 : -0.5) * BENCH_CAR_LENGTH,
+                                   cy + ((c & 2) ? 0.5 : -0.5) * BENCH_CAR_WIDTH,
+                                   BENCH_GROUND_Z + ((c & 4) ? BENCH_CAR_HEIGHT : 0), 1);
+            Eigen::Vector3d uv = projection * corner;
+            umin = std::min(umin, uv(0) / uv(2));
+            umax = std::max(umax, uv(0) / uv(2));
+            vmin = std::min(vmin, uv(1) / uv(2));
+            vmax = std::max(vmax, uv(1) / uv(2));
+        }
+        Box2d box;
+        box.obj_class = BOX_CLASS_CAR;
+        box.probability = 0.9;
+        box.id = det_boxes.size();
+        box.xmin = std::max(0.0, umin);
+        box.ymin = std::max(0.0, vmin);
+        box.xmax = std::min((double)KittiRig::img_length, umax);
+        box.ymax = std::min((double)KittiRig::img_width, vmax);
+        det_boxes.push_back(box);
+    }
+    /*****************************************************
+    *功能：半径3~60米内的地面点
+    *****************************************************/
+    void addGround(const size_t points, std::mt19937& rng) {
+        std::uniform_real_distribution<float> radius(3, 60), theta(-M_PI, M_PI), intensity(0, 20);
+        std::normal_distribution<float> noise(0, 0.02);
+        for (size_t i = 0; i < points; i++) {
+            float r = radius(rng), t = theta(rng);
+            pcl::PointXYZI p;
+            p.x = r * cos(t);
+            p.y = r * sin(t);
+            p.z = BENCH_GROUND_Z + noise(rng);
+            p.intensity = intensity(rng);
+            cloud->points.push_back(p);
+        }
+    }
+};
+
+/*****************************************************
+*功能：初始化融合对象并计算遮挡表，供视锥剪裁等单项测试使用
+*****************************************************/
+static void initialize_fusion(const SyntheticScene& scene, LinkList<detection_cam>& frame, detection_fusion& detection) {
+    detection.Initialize(frame, scene.det_boxes, scene.obj_boxes, scene.cloud, scene.P, scene.R, scene.T);
+    detection.occlusion_table_calc();
+}
+/*****************************************************
+*功能：各检测框的视锥点云与聚类后的车辆点云
+*****************************************************/
+static void car_clouds(const SyntheticScene& scene, std::vector<pcl::PointCloud<pcl::PointXYZI>::Ptr>& fru,
+                       std::vector<pcl::PointIndices>& fru_indices, std::vector<pcl::PointCloud<pcl::PointXYZI>::Ptr>& cars) {
+    LinkList<detection_cam> frame(MAX_DETECT_PER_FRAME);
+    detection_fusion detection;
+    initialize_fusion(scene, frame, detection);
+    for (const auto& box : scene.det_boxes) {
+        pcl::PointCloud<pcl::PointXYZI>::Ptr fruCloud (new pcl::PointCloud<pcl::PointXYZI>);
+        pcl::PointCloud<pcl::PointXYZI>::Ptr carCloud (new pcl::PointCloud<pcl::PointXYZI>);
+        pcl::PointIndices indices, carIndices;
+        detection.clip_frustum(box, fruCloud, indices);
+        if (fruCloud->points.empty()) continue;
+        if (!detection.eu_cluster(fruCloud, indices, carCloud, carIndices)) continue;
+        fru.push_back(fruCloud);
+        fru_indices.push_back(indices);
+        cars.push_back(carCloud);
+    }
+}
+/*****************************************************
+*功能：用于IoU、重叠区域与匹配测试的一帧检测框，next为下一帧（平移后）的检测框
+*****************************************************/
+static Boxes2d random_boxes(const size_t count, const unsigned seed, const Boxes2d* prev = nullptr) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0, KittiRig::img_length - 200), v(100, KittiRig::img_width - 100), size(40, 200), shift(-8, 8);
+    Boxes2d boxes(count);
+    for (size_t i = 0; i < count; i++) {
+        if (prev) {
+            boxes[i] = (*prev)[i];
+            double du = shift(rng), dv = shift(rng);
+            boxes[i].xmin += du; boxes[i].xmax += du;
+            boxes[i].ymin += dv; boxes[i].ymax += dv;
+        } else {
+            boxes[i].xmin = u(rng);
+            boxes[i].ymin = v(rng);
+            boxes[i].xmax = boxes[i].xmin + size(rng);
+            boxes[i].ymax = boxes[i].ymin + size(rng) / 2;
+        }
+    }
+    return boxes;
+}
+
+static void BM_GroundRemove(benchmark::State& state) {
+    SyntheticScene scene(state.range(0), state.range(1));
+    for (auto _ : state) {
+        GroundRemove groundOffCloud(scene.cloud);
+        benchmark::DoNotOptimize(groundOffCloud.ptrCloud->points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scene.cloud->points.size());
+}
+BENCHMARK(BM_GroundRemove)->ArgsProduct({{30000, 60000, 120000}, {4}})->Unit(benchmark::kMillisecond);
+
+static void BM_GroundRemoveCached(benchmark::State& state) {
+    SyntheticScene scene(state.range(0), state.range(1));
+    GroundModel model;
+    for (auto _ : state) {
+        GroundRemove groundOffCloud(scene.cloud, &model);
+        benchmark::DoNotOptimize(groundOffCloud.ptrCloud->points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * scene.cloud->points.size());
+}
+BENCHMARK(BM_GroundRemoveCached)->ArgsProduct({{30000, 60000, 120000}, {4}})->Unit(benchmark::kMillisecond);
+
+static void BM_GroundRemoveRecorded(benchmark::State& state) {
+    const char* bin_file = getenv("SENSOR_FUSION_BENCH_BIN");
+    if (!bin_file) {state.SkipWithError("SENSOR_FUSION_BENCH_BIN is not set"); return;}
+    std::vector<uint8_t> bin;
+    if (!read_velodyne_file(bin_file, bin) || bin.empty()) {state.SkipWithError("Empty point cloud"); return;}
+    PointCloudView view(bin.data(), bin.size() / VELODYNE_POINT_STEP, 1, VELODYNE_POINT_STEP, bin.size(), 0, 4, 8, 12);
+    for (auto _ : state) {
+        GroundRemove groundOffCloud(view);
+        benchmark::DoNotOptimize(groundOffCloud.ptrCloud->points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * view.size());
+}
+BENCHMARK(BM_GroundRemoveRecorded)->Unit(benchmark::kMillisecond);
+
+static void BM_ClipFrustum(benchmark::State& state) {
+    SyntheticScene scene(state.range(0), state.range(1));
+    LinkList<detection_cam> frame(MAX_DETECT_PER_FRAME);
+    detection_fusion detection;
+    initialize_fusion(scene, frame, detection);
+    for (auto _ : state)
+        for (const auto& box : scene.det_boxes) {
+            pcl::PointCloud<pcl::PointXYZI>::Ptr fruCloud (new pcl::PointCloud<pcl::PointXYZI>);
+            pcl::PointIndices indices;
+            detection.clip_frustum(box, fruCloud, indices);
+            benchmark::DoNotOptimize(fruCloud->points.data());
+        }
+    state.SetItemsProcessed(state.iterations() * scene.det_boxes.size());
+}
+BENCHMARK(BM_ClipFrustum)->ArgsProduct({{30000, 120000}, {2, 8, 16}});
+
+static void BM_ClipFrustumWithOverlap(benchmark::State& state) {
+    SyntheticScene scene(state.range(0), state.range(1));
+    LinkList<detection_cam> frame(MAX_DETECT_PER_FRAME);
+    detection_fusion detection;
+    initialize_fusion(scene, frame, detection);
+    for (auto _ : state)
+        for (size_t num = 0; num < scene.det_boxes.size(); num++) {
+            pcl::PointCloud<pcl::PointXYZI>::Ptr fruCloud (new pcl::PointCloud<pcl::PointXYZI>);
+            pcl::PointIndices indices;
+            detection.clip_frustum_with_overlap(num, fruCloud, indices);
+            benchmark::DoNotOptimize(fruCloud->points.data());
+        }
+    state.SetItemsProcessed(state.iterations() * scene.det_boxes.size());
+}
+BENCHMARK(BM_ClipFrustumWithOverlap)->ArgsProduct({{30000, 120000}, {2, 8, 16}});
+
+static void BM_EuCluster(benchmark::State& state) {
+    SyntheticScene scene(state.range(0), state.range(1));
+    std::vector<pcl::PointCloud<pcl::PointXYZI>::Ptr> fru, cars;
+    std::vector<pcl::PointIndices> fru_indices;
+    car_clouds(scene, fru, fru_indices, cars);
+    detection_fusion detection;
+    for (auto _ : state)
+        for (size_t k = 0; k < fru.size(); k++) {
+            pcl::PointCloud<pcl::PointXYZI>::Ptr carCloud (new pcl::PointCloud<pcl::PointXYZI>);
+            pcl::PointIndices carIndices;
+            benchmark::DoNotOptimize(detection.eu_cluster(fru[k], fru_indices[k], carCloud, carIndices));
+        }
+    state.SetItemsProcessed(state.iterations() * fru.size());
+}
+BENCHMARK(BM_EuCluster)->ArgsProduct({{30000, 120000}, {2, 8}})->Unit(benchmark::kMillisecond);
+
+static void BM_Lshape(benchmark::State& state) {
+    SyntheticScene scene(state.range(0), state.range(1));
+    std::vector<pcl::PointCloud<pcl::PointXYZI>::Ptr> fru, cars;
+    std::vector<pcl::PointIndices> fru_indices;
+    car_clouds(scene, fru, fru_indices, cars);
+    detection_fusion detection;
+    for (auto _ : state)
+        for (auto& car : cars) {
+            pcl::PointCloud<pcl::PointXYZI>::Ptr ptrSgroup (new pcl::PointCloud<pcl::PointXYZI>);
+            Matrix51f u = Matrix51f::Zero();
+            benchmark::DoNotOptimize(detection.Lshape(car, ptrSgroup, u));
+        }
+    state.SetItemsProcessed(state.iterations() * cars.size());
+}
+BENCHMARK(BM_Lshape)->ArgsProduct({{30000}, {2, 8, 16}});
+
+static void BM_Lfit(benchmark::State& state) {
+    SyntheticScene scene(state.range(0), state.range(1));
+    std::vector<pcl::PointCloud<pcl::PointXYZI>::Ptr> fru, cars, sgroups;
+    std::vector<pcl::PointIndices> fru_indices;
+    car_clouds(scene, fru, fru_indices, cars);
+    detection_fusion detection;
+    for (auto& car : cars) {
+        pcl::PointCloud<pcl::PointXYZI>::Ptr ptrSgroup (new pcl::PointCloud<pcl::PointXYZI>);
+        Matrix51f u = Matrix51f::Zero();
+        if (detection.Lshape(car, ptrSgroup, u) > 0) sgroups.push_back(ptrSgroup);
+    }
+    for (auto _ : state)
+        for (auto& sgroup : sgroups) {
+            Matrix51f u = Matrix51f::Zero();
+            benchmark::DoNotOptimize(detection.Lfit(sgroup, u));
+        }
+    state.SetItemsProcessed(state.iterations() * sgroups.size());
+}
+BENCHMARK(BM_Lfit)->ArgsProduct({{30000}, {2, 8, 16}});
+
+static void BM_OverlapBox(benchmark::State& state) {
+    Boxes2d boxes = random_boxes(state.range(0), 1);
+    detection_fusion detection;
+    for (auto _ : state)
+        for (size_t i = 0; i < boxes.size(); i++)
+            for (size_t j = i + 1; j < boxes.size(); j++)
+                benchmark::DoNotOptimize(detection.overlap_box(boxes[i], boxes[j]));
+    state.SetItemsProcessed(state.iterations() * boxes.size() * (boxes.size() - 1) / 2);
+}
+BENCHMARK(BM_OverlapBox)->Arg(4)->Arg(16)->Arg(64);
+
+static void BM_IoU(benchmark::State& state) {
+    Boxes2d prev = random_boxes(state.range(0), 1);
+    Boxes2d curr = random_boxes(state.range(0), 2, &prev);
+    for (auto _ : state)
+        for (const auto& p : prev)
+            for (const auto& c : curr)
+                benchmark::DoNotOptimize(IoU(p, c));
+    state.SetItemsProcessed(state.iterations() * prev.size() * curr.size());
+}
+BENCHMARK(BM_IoU)->Arg(4)->Arg(16)->Arg(64);
+
+static void BM_BevIoU(benchmark::State& state) {
+    std::mt19937 rng(4);
+    std::uniform_real_distribution<float> pos(-2, 2), heading(-M_PI, M_PI);
+    std::vector<Box3d> boxes(state.range(0));
+    for (auto& box : boxes) {
+        box.pos.x = pos(rng);
+        box.pos.y = pos(rng);
+        box.length = BENCH_CAR_LENGTH;
+        box.width = BENCH_CAR_WIDTH;
+        box.heading = heading(rng);
+    }
+    for (auto _ : state)
+        for (size_t i = 0; i < boxes.size(); i++)
+            for (size_t j = 0; j < boxes.size(); j++)
+                benchmark::DoNotOptimize(bev_iou(boxes[i], boxes[j]));
+    state.SetItemsProcessed(state.iterations() * boxes.size() * boxes.size());
+}
+BENCHMARK(BM_BevIoU)->Arg(4)->Arg(16)->Arg(64);
+
+static void BM_Hungaria(benchmark::State& state) {
+    size_t count = state.range(0);
+    Boxes2d prev_boxes = random_boxes(count, 1);
+    Boxes2d curr_boxes = random_boxes(count, 2, &prev_boxes);
+    for (auto _ : state) {
+        state.PauseTiming();
+        ObjectList carList(MAX_OBJECT_IN_LIST);
+        LinkList<detection_cam> empty(count), detectPrev(count), detectCurr(count);
+        for (size_t i = 0; i < count; i++) {
+            detection_cam det;
+            det.box = prev_boxes[i];
+            detectPrev.addItem(det);
+            det.box = curr_boxes[i];
+            detectCurr.addItem(det);
+        }
+        Hungaria(empty, detectPrev, &carList);
+        state.ResumeTiming();
+        Hungaria(detectPrev, detectCurr, &carList);
+        benchmark::DoNotOptimize(detectCurr.count());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_Hungaria)->Arg(4)->Arg(8)->Arg(16)->Arg(MAX_DETECT_PER_FRAME);
+
+static void BM_TrackStateEngine(benchmark::State& state) {
+    size_t count = state.range(0);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> pos(-40, 40), noise(-0.3, 0.3);
+    TrackStateEngine engine;
+    std::vector<float> px(count), py(count);
+    for (size_t i = 0; i < count; i++) {
+        px[i] = pos(rng);
+        py[i] = pos(rng);
+        engine.add(i + 1);
+        engine.setMeasurement(i + 1, px[i], py[i]);
+    }
+    for (auto _ : state) {
+        engine.predict(TRACK_DEFAULT_DT);
+        for (size_t i = 0; i < count; i++)
+            if (engine.gateDistance(i + 1, px[i] + noise(rng), py[i] + noise(rng)) <= KF_GATE_CHI2)
+                engine.setMeasurement(i + 1, px[i] + noise(rng), py[i] + noise(rng));
+        engine.update();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_TrackStateEngine)->Arg(50)->Arg(300)->Arg(1000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,27 @@
+#ifndef BOX_METRICS_H
+#define BOX_METRICS_H
+#include "sensor_fusion/FusionTypes.h"
+#include <string>
+
+#define MIN_BEV_IoU 0.1                // min BEV IoU for two 3d boxes to be associated
+#define MAX_CENTER_DISTANCE 2.0        // max BEV center distance for two 3d boxes to be associated, meters
+#define GATING_BEV_CELL_SIZE 4.0       // cell edge of the BEV grid used by Hungaria, meters
+
+/*************************************************************************
+*文件名：BoxMetrics.h
+*功能：鸟瞰图下三维检测框（中心pos、长length沿heading方向、宽width）的关联度量：
+*旋转矩形IoU与中心距离，以及跟踪关联代价的选择
+**************************************************************************/
+enum AssociationMetric {
+    ASSOC_IOU_2D = 0,              // image IoU of the 2d boxes
+    ASSOC_IOU_BEV,                 // rotated-rectangle IoU of the 3d boxes
+    ASSOC_CENTER_DISTANCE,         // BEV distance between the 3d box centers
+    ASSOC_METRIC_COUNT
+};
+bool association_metric_from_name(const std::string& name, AssociationMetric& metric);
+const char* association_metric_name(const AssociationMetric metric);
+
+float bev_iou(const Box3d& box_a, const Box3d& box_b);
+float center_distance(const Box3d& box_a, const Box3d& box_b);
+void bev_extent(const Box3d& box3d, float &xmin, float &ymin, float &xmax, float &ymax);
+#endif
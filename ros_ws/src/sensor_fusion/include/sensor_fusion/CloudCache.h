@@ -0,0 +1,76 @@
+#ifndef CLOUD_CACHE_H
+#define CLOUD_CACHE_H
+#include "sensor_fusion/detection_fusion.h"
+#include "sensor_fusion/GroundRemove.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#define CLOUD_CACHE_SIZE 8         // preprocessed clouds kept for late consumers
+
+/*************************************************************************
+*文件名：CloudCache.h
+*功能：按帧共享的预处理点云缓存。地面去除后的点云以及各标定下的图像投影只计算一次，
+*同一进程中的其他消费者（其他相机的融合、占据栅格建图等）按点云坐标系、时间戳与
+*地面去除方式取用。条目以shared_ptr引用计数，被逐出缓存后仍对持有者有效；
+*点云与派生数据在插入后只读，投影在首次请求时计算
+**************************************************************************/
+enum GroundMode {
+    GROUND_PER_FRAME,              // every frame segmented on its own
+    GROUND_TEMPORAL                // sectors classified by the cached GroundModel
+};
+typedef std::vector<GroundModel::Sector> GroundSectors;
+
+/*************************************************************************
+*功能：单帧预处理点云及其按需计算的派生数据，可被多个线程同时读取
+*************************************************************************/
+class PreprocessedCloud {
+private:
+    struct CachedProjection {
+        std::array<double, 13> key;                         // projection matrix and near plane
+        std::shared_ptr<const CloudProjection> projection;
+    };
+    std::mutex mtx;
+    std::vector<CachedProjection> projections;
+public:
+    const int64_t stamp;
+    const pcl::PointCloud<pcl::PointXYZI>::Ptr groundOffCloud;     // read-only once inserted
+    const std::shared_ptr<const GroundSectors> groundSectors;      // ground model after this frame, GROUND_TEMPORAL only
+    PreprocessedCloud(const int64_t stamp_, const pcl::PointCloud<pcl::PointXYZI>::Ptr ground_off,
+                      const std::shared_ptr<const GroundSectors> ground_sectors = nullptr)
+        : stamp(stamp_), groundOffCloud(ground_off), groundSectors(ground_sectors) {}
+    std::shared_ptr<const CloudProjection> projection(const Matrix34d& point_projection_matrix, const double near);
+};
+typedef std::shared_ptr<PreprocessedCloud> PreprocessedCloudPtr;
+
+/*************************************************************************
+*功能：进程内共享的预处理点云缓存，按（点云坐标系，时间戳，地面去除方式）索引，
+*超出容量时逐出最早的帧。容量取各消费者请求中的最大值
+*************************************************************************/
+class CloudCache {
+private:
+    typedef std::tuple<std::string, int64_t, GroundMode> Key;
+    mutable std::mutex mtx;
+    std::map<Key, PreprocessedCloudPtr> entries;
+    size_t capacity;
+    size_t hits;
+    size_t misses;
+    CloudCache() : capacity(0), hits(0), misses(0) {}
+    void evict();
+public:
+    static CloudCache& instance();
+    void reserve(const size_t frames);
+    PreprocessedCloudPtr find(const std::string& source, const int64_t stamp, const GroundMode mode);
+    PreprocessedCloudPtr insert(const std::string& source, const int64_t stamp, const GroundMode mode,
+                                const pcl::PointCloud<pcl::PointXYZI>::Ptr ground_off,
+                                const std::shared_ptr<const GroundSectors> ground_sectors = nullptr);
+    void clear();
+    size_t size() const;
+    void stats(size_t& hits_, size_t& misses_) const;
+};
+#endif
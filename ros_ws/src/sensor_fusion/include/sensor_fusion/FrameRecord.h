@@ -0,0 +1,126 @@
+#ifndef FRAME_RECORD_H
+#define FRAME_RECORD_H
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "sensor_fusion/detection_fusion.h"
+
+/*************************************************************************
+*文件名：FrameRecord.h
+*功能：融合结果的带索引二进制容器（主机字节序）
+*文件依次为：
+*FrameFileHeader
+*帧记录 × frame_count，每帧依次为：
+*  FrameRecordHeader
+*  BoxRecord × box_count（检测框段）
+*  各检测框的frustum/surface/vehicle点云，float x,y,z（点云段）
+*  各检测框的车辆点云在去地面点云中的索引，int32
+*FrameIndexEntry × frame_count（帧索引表，位于index_offset）
+*所有段的长度均为4字节的整数倍，内存映射后可直接按类型访问
+**************************************************************************/
+#define FRAME_FILE_MAGIC 0x46435246     // "FRCF"
+#define FRAME_FILE_VERSION 1
+#define FRAME_RECORD_MAGIC 0x43455246   // "FREC"
+
+#pragma pack(push, 1)
+struct FrameFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t frame_count;
+    uint64_t index_offset;   // 0 while the file is still being written
+    uint64_t reserved;
+};
+struct FrameIndexEntry {
+    uint64_t frame;
+    int64_t stamp;
+    uint64_t offset;         // of the FrameRecordHeader from the start of the file
+    uint32_t size;
+    uint32_t box_count;
+};
+struct FrameRecordHeader {
+    uint32_t magic;
+    uint32_t size;           // bytes of the whole record, header included
+    uint64_t frame;          // frame index since the node started
+    int64_t stamp;           // point cloud stamp, nanoseconds
+    uint32_t box_count;
+    uint32_t point_count;    // points of all boxes and all three clouds
+};
+struct BoxRecord {
+    int32_t id;              // track id
+    int32_t slot;            // position in the detection list of the frame
+    float box2d[4];          // center u, center v, width, height in pixels
+    float box3d[7];          // x, y, z, length, width, height, heading
+    uint32_t fru_count;
+    uint32_t sur_count;
+    uint32_t car_count;
+    uint32_t index_count;
+};
+#pragma pack(pop)
+
+/*****************************************************
+*功能：将一帧中未丢失的检测结果序列化并追加到缓冲区末尾
+*输入：
+*buffer: 用于储存记录的缓冲区
+*frame: 帧序号
+*stamp: 点云时间戳，纳秒
+*detections: 单帧检测结果
+******************************************************/
+void append_frame_record(std::vector<char>& buffer, const uint64_t frame, const int64_t stamp,
+                         LinkList<detection_cam>& detections);
+
+/*************************************************************************
+*功能：顺序写入帧记录，关闭时写入帧索引表并回填文件头
+*************************************************************************/
+class FrameRecordWriter {
+private:
+    FILE* file;
+    uint64_t offset;
+    std::vector<FrameIndexEntry> index;
+public:
+    FrameRecordWriter() : file(nullptr), offset(0) {}
+    ~FrameRecordWriter() {close();}
+    FrameRecordWriter(const FrameRecordWriter&) = delete;
+    FrameRecordWriter& operator = (const FrameRecordWriter&) = delete;
+    bool open(const std::string& path);
+    bool isOpen() const {return file != nullptr;}
+    size_t append(const char* records, const size_t size);
+    uint64_t bytes() const {return offset;}
+    void close();
+};
+
+/*************************************************************************
+*功能：单帧记录的只读视图，指针均指向内存映射的文件
+*************************************************************************/
+struct FrameView {
+    const FrameRecordHeader* header = nullptr;
+    const BoxRecord* boxes = nullptr;
+    const float* points = nullptr;       // x,y,z of fru/sur/car clouds, box after box
+    const int32_t* indices = nullptr;    // vehicle cloud indices, box after box
+    const float* cloud(const size_t box, const int which, uint32_t& count) const;
+};
+
+/*************************************************************************
+*功能：内存映射读取融合结果文件，按帧随机访问而无需解析。
+*未正常关闭（没有索引表）的文件会顺序扫描一次帧记录重建索引
+*************************************************************************/
+class FrameRecordReader {
+private:
+    const char* data;
+    size_t length;
+    std::vector<FrameIndexEntry> index;
+    bool rebuildIndex();
+    bool checkRecord(const uint64_t offset, const uint64_t size) const;
+public:
+    enum {FRUSTUM = 0, SURFACE = 1, VEHICLE = 2};
+    FrameRecordReader() : data(nullptr), length(0) {}
+    ~FrameRecordReader() {close();}
+    FrameRecordReader(const FrameRecordReader&) = delete;
+    FrameRecordReader& operator = (const FrameRecordReader&) = delete;
+    bool open(const std::string& path);
+    void close();
+    size_t count() const {return index.size();}
+    const FrameIndexEntry& entry(const size_t i) const {return index[i];}
+    bool getFrame(const size_t i, FrameView& view) const;
+};
+#endif
@@ -0,0 +1,73 @@
+#ifndef FUSION_TYPES_H
+#define FUSION_TYPES_H
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/*************************************************************************
+*文件名：FusionTypes.h
+*功能：融合算法使用的检测框类型，不依赖ROS。
+*检测框均为紧凑的POD结构（float坐标、类别枚举），按const引用传递，
+*在热路径上复制与比较时没有字符串与整型转换；
+*节点中与darknet_ros_msgs消息之间的转换见data_utils.hpp
+**************************************************************************/
+enum BoxClass : uint8_t {
+    BOX_CLASS_CAR = 0,
+    BOX_CLASS_TRUCK,
+    BOX_CLASS_BUS,
+    BOX_CLASS_PERSON,
+    BOX_CLASS_BICYCLE,
+    BOX_CLASS_MOTORBIKE,
+    BOX_CLASS_OTHER,
+    BOX_CLASS_COUNT
+};
+struct Point3f {
+    float x = 0;
+    float y = 0;
+    float z = 0;
+};
+/*************************************************************************
+*功能：图像二维检测框，像素坐标
+*************************************************************************/
+struct Box2d {
+    float xmin = 0;
+    float ymin = 0;
+    float xmax = 0;
+    float ymax = 0;
+    float probability = 0;
+    int16_t id = 0;
+    BoxClass obj_class = BOX_CLASS_OTHER;
+};
+/*************************************************************************
+*功能：激光雷达坐标系下的三维检测框
+*************************************************************************/
+struct Box3d {
+    float length = 0;
+    float width = 0;
+    float height = 0;
+    float heading = 0;
+    float corner_x = 0;
+    float corner_y = 0;
+    Point3f pos;
+    int16_t id = 0;
+    BoxClass obj_class = BOX_CLASS_OTHER;
+};
+typedef std::vector<Box2d> Boxes2d;
+typedef std::vector<Box3d> Boxes3d;
+
+/*****************************************************
+*功能：检测器输出的类别名称转换为类别枚举，未知类别为BOX_CLASS_OTHER
+*****************************************************/
+inline BoxClass box_class_from_name(const char* name) {
+    static const char* names[BOX_CLASS_OTHER] = {"car", "truck", "bus", "person", "bicycle", "motorbike"};
+    for (int i = 0; i < BOX_CLASS_OTHER; i++)
+        if (!strcmp(name, names[i])) return (BoxClass)i;
+    return BOX_CLASS_OTHER;
+}
+/*****************************************************
+*功能：是否为按车辆处理的类别
+*****************************************************/
+inline bool is_vehicle_class(const BoxClass obj_class) {
+    return obj_class == BOX_CLASS_CAR || obj_class == BOX_CLASS_TRUCK;
+}
+#endif
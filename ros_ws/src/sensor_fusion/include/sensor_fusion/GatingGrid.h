@@ -0,0 +1,34 @@
+#ifndef GATING_GRID_H
+#define GATING_GRID_H
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#define GATING_CELL_SIZE 64        // cell edge of the image-space grid used by Hungaria, pixels
+
+/*************************************************************************
+*文件名：GatingGrid.h
+*功能：关联前的空间哈希。将当前帧检测框的外接矩形登记到其覆盖的所有网格中，
+*查询时只返回与查询矩形共享网格的检测，作为候选参与关联代价计算。
+*两个矩形相交时必然共享网格，因此对需要重叠的代价（IoU）不会漏掉匹配；
+*坐标单位任意（图像像素或鸟瞰图米），与cell_size一致即可
+**************************************************************************/
+class GatingGrid {
+private:
+    float cell_size;
+    std::unordered_map<uint64_t, std::vector<size_t>> cells;
+    std::vector<uint32_t> visited;     // query stamp of each entry, removes duplicates across cells
+    uint32_t query_stamp;
+    size_t entries;
+    // cells behind or left of the sensor are negative, shift them as unsigned
+    static uint64_t cellKey(const int64_t cx, const int64_t cy) {return ((uint64_t)cx << 32) ^ ((uint64_t)cy & 0xffffffff);}
+    int64_t cellOf(const float v) const;
+public:
+    explicit GatingGrid(const float cell_size_) : cell_size(cell_size_), query_stamp(0), entries(0) {}
+    void clear();
+    size_t size() const {return entries;}
+    void insert(const float xmin, const float ymin, const float xmax, const float ymax, const size_t index);
+    void query(const float xmin, const float ymin, const float xmax, const float ymax, std::vector<size_t>& candidates);
+};
+#endif
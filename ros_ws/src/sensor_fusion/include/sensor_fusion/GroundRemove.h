@@ -1,28 +1,44 @@
 #ifndef GROUND_REMOVE_H
 #define GROUND_REMOVE_H
 
-#include <rclcpp/rclcpp.hpp>
-#include <pcl_conversions/pcl_conversions.h>
 #include <pcl/point_types.h>
-#include <pcl/conversions.h>
-//#include <pcl_ros/transforms.h>
 #include <pcl/filters/extract_indices.h>
-#include <sensor_msgs/msg/point_cloud2.h>
-
-#define CLIP_HEIGHT 0.2 //截取掉高于雷达自身0.2米的点
-#define MIN_DISTANCE 2.4
-#define RADIAL_DIVIDER_ANGLE 0.09
-#define SENSOR_HEIGHT 1.78
-
-#define concentric_divider_distance_ 0.01 //0.1 meters default
-#define min_height_threshold_ 0.05
-#define local_max_slope_ 8   //max slope of the ground between points, degree
-#define general_max_slope_ 5 //max slope of the ground in entire point cloud, degree
-#define reclass_distance_threshold_ 0.2
+#include "sensor_fusion/PointCloudView.hpp"
+#include "sensor_fusion/SensorProfile.h"
 
+// Temporal ground model
+#define GROUND_SECTOR_DIVS 20          //radial divisions sharing one ground model sector (1.8 degree)
+#define GROUND_RESIDUAL_TOL 0.15       //max distance to the cached ground line to be classified as ground, meters
+#define GROUND_OUTLIER_RATIO 0.05      //max ratio of points below the cached ground line before re-segmentation
+#define GROUND_BAND_DROP 0.5           //min ratio of the last in-band fraction kept before re-segmentation
+#define GROUND_NEAR_RADIUS 10.0        //radius within which ground rising above the band is checked, meters
+#define GROUND_RISE_TOL 0.3            //points between GROUND_RESIDUAL_TOL and this above the line count as risen ground
+#define GROUND_MODEL_MIN_POINTS 5      //min ground points to fit a sector model
+#define GROUND_MODEL_REFRESH 10        //frames before a sector is re-segmented regardless of its residuals
 
+/*************************************************************************
+*功能：分扇区的地面模型，缓存上一帧每个扇区拟合的地面高度与坡度
+*************************************************************************/
+class GroundModel {
+public:
+    struct Sector {
+        bool valid = false;
+        float height = 0;              //ground height at radius 0
+        float slope = 0;               //dz/dr of the ground line
+        float ground_ratio = 0;        //fraction of the sector points classified as ground
+    };
+    std::vector<Sector> sectors;
+    size_t frame = 0;
+    size_t cached_sectors = 0;         //sectors classified by the cached model in the last frame
+    size_t segmented_sectors = 0;      //sectors fully re-segmented in the last frame
+    void Reset() {sectors.clear(); frame = 0;}
+};
 
-class GroundRemove {
+/*************************************************************************
+*功能：基于径向分组的地面去除，按rig参数（见SensorProfile.h）实例化
+*************************************************************************/
+template<typename Rig>
+class BasicGroundRemove {
 private:
     size_t radial_dividers_num_;
     size_t concentric_dividers_num_;
@@ -35,20 +51,21 @@ private:
         size_t original_index; //index of this point in the source pointcloud
     };
     typedef std::vector<PointXYZIRTColor> PointCloudXYZIRTColor;
-    void Preprocess();
-    void ClipAbove(const pcl::PointCloud<pcl::PointXYZI>::Ptr in,
-                   const pcl::PointCloud<pcl::PointXYZI>::Ptr out, double clip_height);
-    void RemoveClose(const pcl::PointCloud<pcl::PointXYZI>::Ptr in,
-                     const pcl::PointCloud<pcl::PointXYZI>::Ptr out, double min_distance);
-    void XYZI_to_RTZColor(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud,
-                          PointCloudXYZIRTColor &out_organized_points,
-                          std::vector<pcl::PointIndices> &out_radial_divided_indices,
+    void Preprocess(const PointCloudView &in_view);
+    void XYZI_to_RTZColor(const PointCloudView &in_view,
                           std::vector<PointCloudXYZIRTColor> &out_radial_ordered_clouds);
     void GroundOff(std::vector<PointCloudXYZIRTColor> &in_radial_ordered_clouds,
                    pcl::PointIndices &out_ground_indices);
+    void SegmentDivision(PointCloudXYZIRTColor &in_radial_cloud, pcl::PointIndices &out_ground_indices,
+                         double (&fit)[5]);
+    bool CachedSector(const GroundModel::Sector &sector, const std::vector<PointCloudXYZIRTColor> &in_radial_ordered_clouds,
+                      size_t div_begin, size_t div_end, pcl::PointIndices &out_ground_indices, double (&fit)[5]);
+    GroundModel* ptrModel;
 public:
     pcl::PointCloud<pcl::PointXYZI>::Ptr ptrCloud;
-    GroundRemove(pcl::PointCloud<pcl::PointXYZI>::Ptr inCloud) : ptrCloud(inCloud) {Preprocess();}
-    ~GroundRemove() {}
+    BasicGroundRemove(pcl::PointCloud<pcl::PointXYZI>::Ptr inCloud, GroundModel* model = nullptr) : ptrModel(model), ptrCloud(inCloud) {Preprocess(PointCloudView(*inCloud));}
+    BasicGroundRemove(const PointCloudView &inView, GroundModel* model = nullptr) : ptrModel(model) {Preprocess(inView);}
+    ~BasicGroundRemove() {}
 };
+typedef BasicGroundRemove<KittiRig> GroundRemove;
 #endif
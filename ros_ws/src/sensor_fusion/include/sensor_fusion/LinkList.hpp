@@ -40,6 +40,8 @@ public:
     Item& getItem(const size_t itemNum);
     bool getItem(const size_t itemNum, Item& item);
     Item* getPtrItem(const size_t itemNum);
+    template<typename Function>
+    void forEach(Function visit);    // visit every item in order
 };
 
 /*****************************************************
@@ -256,4 +258,15 @@ Item* LinkList<Item>::getPtrItem(const size_t itemNum) {
         return ptrItem;
     }
 }
+/*****************************************************
+*功能：按顺序访问所有元素，整个队列只遍历一次
+*输入：
+*visit：以元素引用为参数的函数
+******************************************************/
+template<typename Item>
+template<typename Function>
+void LinkList<Item>::forEach(Function visit) {
+    for (Node* check = front; check != NULL; check = check->next)
+        visit(check->item);
+}
 #endif
@@ -0,0 +1,80 @@
+#ifndef POINT_CLOUD_VIEW_H
+#define POINT_CLOUD_VIEW_H
+#include <cstdint>
+#include <cstring>
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+
+/*************************************************************************
+*文件名：PointCloudView.hpp
+*功能：按字段偏移直接读取点云缓冲区中的x/y/z/intensity，不做格式转换。
+*可包装sensor_msgs::msg::PointCloud2的data（见data_utils.hpp中的view_from_msg）
+*或pcl::PointCloud<pcl::PointXYZI>，缓冲区需在视图使用期间保持有效
+**************************************************************************/
+class PointCloudView {
+private:
+    const uint8_t* data;
+    size_t width;
+    size_t height;
+    size_t point_step;
+    size_t row_step;
+    uint32_t offset_x, offset_y, offset_z, offset_i;
+    bool has_intensity;
+    bool packed;        // rows are contiguous, a point is at data + i*point_step
+
+    float field(size_t i, uint32_t offset) const {
+        const uint8_t* p = packed ? data + i * point_step
+                                  : data + (i / width) * row_step + (i % width) * point_step;
+        float value;
+        std::memcpy(&value, p + offset, sizeof(float));
+        return value;
+    }
+    static uint32_t pcl_offset(const pcl::PointXYZI& p, const float& f) {
+        return (uint32_t)(reinterpret_cast<const uint8_t*>(&f) - reinterpret_cast<const uint8_t*>(&p));
+    }
+public:
+    PointCloudView() : data(nullptr), width(0), height(0), point_step(0), row_step(0),
+                       offset_x(0), offset_y(0), offset_z(0), offset_i(0), has_intensity(false), packed(true) {}
+    /*****************************************************
+    *功能：包装原始缓冲区，字段均为float32且与主机字节序一致
+    *输入：
+    *data_: 缓冲区首地址
+    *width_/height_: 点云的列数与行数
+    *point_step_/row_step_: 单点与单行的字节数
+    *x/y/z/i: 各字段的字节偏移，i为负表示没有强度字段
+    *****************************************************/
+    PointCloudView(const uint8_t* data_, size_t width_, size_t height_, size_t point_step_, size_t row_step_,
+                   uint32_t x, uint32_t y, uint32_t z, int64_t i)
+        : data(data_), width(width_), height(height_), point_step(point_step_), row_step(row_step_),
+          offset_x(x), offset_y(y), offset_z(z), offset_i(i < 0 ? 0 : (uint32_t)i), has_intensity(i >= 0),
+          packed(height_ <= 1 || row_step_ == width_ * point_step_) {}
+    /*****************************************************
+    *功能：包装PCL点云，不复制数据
+    *****************************************************/
+    explicit PointCloudView(const pcl::PointCloud<pcl::PointXYZI>& cloud)
+        : data(reinterpret_cast<const uint8_t*>(cloud.points.data())), width(cloud.points.size()), height(1),
+          point_step(sizeof(pcl::PointXYZI)), row_step(cloud.points.size() * sizeof(pcl::PointXYZI)),
+          has_intensity(true), packed(true) {
+        pcl::PointXYZI p;
+        offset_x = pcl_offset(p, p.x);
+        offset_y = pcl_offset(p, p.y);
+        offset_z = pcl_offset(p, p.z);
+        offset_i = pcl_offset(p, p.intensity);
+    }
+
+    size_t size() const {return width * height;}
+    bool empty() const {return size() == 0;}
+    float x(size_t i) const {return field(i, offset_x);}
+    float y(size_t i) const {return field(i, offset_y);}
+    float z(size_t i) const {return field(i, offset_z);}
+    float intensity(size_t i) const {return has_intensity ? field(i, offset_i) : 0.f;}
+    pcl::PointXYZI point(size_t i) const {
+        pcl::PointXYZI p;
+        p.x = x(i);
+        p.y = y(i);
+        p.z = z(i);
+        p.intensity = intensity(i);
+        return p;
+    }
+};
+#endif
@@ -0,0 +1,119 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*************************************************************************
+*文件名：Profiler.h
+*功能：轻量的分阶段耗时统计。每个阶段对应一个对数-线性分桶的直方图（HDR风格），
+*记录只做几次原子加法，无锁无分配；关闭时PROFILE_SCOPE只读一次原子标志。
+*定义SENSOR_FUSION_NO_PROFILING可在编译期完全去掉插桩
+**************************************************************************/
+#define HIST_SUB_BITS 4                            // 16 linear sub-buckets per power of two, ~6% resolution
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS)
+
+enum ProfileStage {
+    PROF_FROM_ROS_MSG = 0,
+    PROF_GROUND_REMOVE,
+    PROF_PROJECT_CLOUD,
+    PROF_OCCLUSION_TABLE,
+    PROF_CLIP_FRUSTUM,
+    PROF_EU_CLUSTER,
+    PROF_LFIT,
+    PROF_HUNGARIA,
+    PROF_RESULT_LOG,
+    PROF_DRAWING,
+    PROF_FRAME,                 // ingest to published
+    PROF_STAGE_COUNT
+};
+enum ProfileCounter {
+    CNT_POINTS_IN = 0,
+    CNT_POINTS_GROUND_FREE,
+    CNT_BOXES,
+    CNT_CLUSTERS,
+    CNT_COUNTER_COUNT
+};
+
+/*************************************************************************
+*功能：对数-线性分桶的无锁直方图，可被多个线程同时记录
+*************************************************************************/
+class Histogram {
+private:
+    std::atomic<uint64_t> buckets[HIST_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max_value;
+    static size_t bucketOf(const uint64_t value);
+    static uint64_t bucketUpper(const size_t bucket);
+public:
+    Histogram() {reset();}
+    void record(const uint64_t value);
+    void reset();
+    uint64_t count() const {return total.load(std::memory_order_relaxed);}
+    uint64_t max() const {return max_value.load(std::memory_order_relaxed);}
+    double mean() const;
+    uint64_t percentile(const double p) const;
+};
+
+struct ProfileStats {
+    std::string name;
+    std::string unit;
+    uint64_t count;
+    double mean;
+    uint64_t p50, p99, max;
+};
+
+/*************************************************************************
+*功能：全局的阶段耗时与单帧计数统计，耗时单位为纳秒
+*************************************************************************/
+class Profiler {
+private:
+    std::atomic<bool> enabled;
+    Histogram stages[PROF_STAGE_COUNT];
+    Histogram counters[CNT_COUNTER_COUNT];
+    Profiler() : enabled(false) {}
+public:
+    static Profiler& instance();
+    static const char* stageName(const int stage);
+    static const char* counterName(const int counter);
+    bool isEnabled() const {return enabled.load(std::memory_order_relaxed);}
+    void setEnabled(const bool enable) {enabled.store(enable, std::memory_order_relaxed);}
+    void record(const ProfileStage stage, const uint64_t ns) {if (isEnabled()) stages[stage].record(ns);}
+    void count(const ProfileCounter counter, const uint64_t value) {if (isEnabled()) counters[counter].record(value);}
+    void reset();
+    std::vector<ProfileStats> snapshot() const;
+    bool writeCsv(const std::string& path) const;
+};
+
+/*************************************************************************
+*功能：作用域计时器，析构时记录耗时
+*************************************************************************/
+class ScopedTimer {
+private:
+    ProfileStage stage;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+public:
+    explicit ScopedTimer(const ProfileStage stage_) : stage(stage_), active(Profiler::instance().isEnabled()) {
+        if (active) start = std::chrono::steady_clock::now();
+    }
+    ~ScopedTimer() {
+        if (active) Profiler::instance().record(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                           std::chrono::steady_clock::now() - start).count());
+    }
+};
+
+#ifdef SENSOR_FUSION_NO_PROFILING
+#define PROFILE_SCOPE(stage)
+#define PROFILE_COUNT(counter, value)
+#else
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage) ScopedTimer PROFILE_CONCAT(profile_timer_, __LINE__)(stage)
+#define PROFILE_COUNT(counter, value) Profiler::instance().count(counter, value)
+#endif
+#endif
@@ -0,0 +1,46 @@
+#ifndef RESULT_LOGGER_H
+#define RESULT_LOGGER_H
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sensor_fusion/FrameRecord.h"
+
+#define RESULT_LOG_MAX_FILE_SIZE (1024ul * 1024 * 1024)   // roll over to a new file after 1 GiB
+#define RESULT_LOG_MAX_BUFFER (64ul * 1024 * 1024)        // records are dropped beyond this backlog
+
+/*************************************************************************
+*功能：异步记录融合结果。调用线程只做序列化并追加到前台缓冲区，
+*后台线程交换双缓冲后写入滚动文件，热路径上没有磁盘IO
+*************************************************************************/
+class ResultLogger {
+private:
+    std::string directory;
+    std::string prefix;
+    size_t max_file_size;
+    std::atomic<bool> enabled;
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<char> front;     // filled by logFrame
+    std::vector<char> back;      // written by the writer thread
+    bool stop;
+    size_t dropped_frames;
+
+    FrameRecordWriter file;
+    size_t file_index;
+    std::thread writer;
+
+    void writerLoop();
+    bool openNextFile();
+public:
+    ResultLogger(const std::string& directory_, const size_t max_file_size_ = RESULT_LOG_MAX_FILE_SIZE);
+    ~ResultLogger();
+    void setEnabled(const bool enable) {enabled = enable;}
+    bool isEnabled() const {return enabled;}
+    size_t droppedFrames();
+    void logFrame(const uint64_t frame, const int64_t stamp, LinkList<detection_cam>& detections);
+};
+#endif
@@ -0,0 +1,42 @@
+#ifndef SENSOR_PROFILE_H
+#define SENSOR_PROFILE_H
+#include <cstddef>
+
+/*************************************************************************
+*文件名：SensorProfile.h
+*功能：相机/激光雷达组合（rig）的编译期参数。
+*视锥剪裁、L形拟合与地面去除按rig实例化（BasicDetectionFusion<Rig>、BasicGroundRemove<Rig>），
+*参数均为编译期常量，便于编译器常量折叠与向量化；同一程序中可同时使用多个rig。
+*新增rig时定义同样字段的结构体，并在detection_fusion.cpp与GroundRemove.cpp末尾显式实例化
+**************************************************************************/
+
+/*************************************************************************
+*功能：KITTI采集车，Velodyne HDL-64E与左侧彩色相机（image_02）
+*************************************************************************/
+struct KittiRig {
+    // Camera image, pixels
+    static constexpr int img_length = 1242;
+    static constexpr int img_width = 375;
+    // Frustum clipping, points closer than this along the camera axis are skipped, meters
+    static constexpr double frustum_near = 3;
+    static constexpr double frustum_overlap_near = 5;
+    // Occlusion between 2d boxes, min overlap ratio along each axis
+    static constexpr double iou_threshold = 0.01;
+    // L-shape fitting
+    static constexpr size_t s_group_threshold = 10;
+    static constexpr size_t s_group_refined_threshold = 5;
+    static constexpr double angle_reso = 0.06;
+    static constexpr int point_num = 5;
+    static constexpr double min_slope = 0.0000001;
+    // Ground removal, lidar mounted sensor_height meters above the ground
+    static constexpr double clip_height = 0.2;                  // drop points higher than the lidar by this much
+    static constexpr double min_distance = 2.4;
+    static constexpr double radial_divider_angle = 0.09;        // degree
+    static constexpr double sensor_height = 1.78;
+    static constexpr double concentric_divider_distance = 0.01;
+    static constexpr double min_height_threshold = 0.05;
+    static constexpr double local_max_slope = 8;                // max slope of the ground between points, degree
+    static constexpr double general_max_slope = 5;              // max slope of the ground in entire point cloud, degree
+    static constexpr double reclass_distance_threshold = 0.2;
+};
+#endif
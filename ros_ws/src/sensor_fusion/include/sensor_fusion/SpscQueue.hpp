@@ -0,0 +1,51 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+/*************************************************************************
+*文件名：SpscQueue.hpp
+*功能：单生产者单消费者的有界无锁队列，用于流水线各阶段之间传递数据。
+*push只能由一个线程调用，pop只能由另一个线程调用
+**************************************************************************/
+template<typename Item>
+class SpscQueue {
+private:
+    enum{CACHE_LINE = 64};
+    std::vector<Item> buffer;        // one slot is kept empty to tell full from empty
+    alignas(CACHE_LINE) std::atomic<size_t> head;   // next slot to pop, written by the consumer
+    alignas(CACHE_LINE) std::atomic<size_t> tail;   // next slot to push, written by the producer
+    size_t next(size_t i) const {return i + 1 == buffer.size() ? 0 : i + 1;}
+public:
+    explicit SpscQueue(const size_t qs) : buffer(qs + 1), head(0), tail(0) {}
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue & operator = (const SpscQueue &) = delete;
+    /*****************************************************
+    *功能：从队末添加元素，队列已满时返回false且不移动item
+    ******************************************************/
+    bool push(Item& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t n = next(t);
+        if (n == head.load(std::memory_order_acquire)) return false;
+        buffer[t] = std::move(item);
+        tail.store(n, std::memory_order_release);
+        return true;
+    }
+    /*****************************************************
+    *功能：从队首取出元素，队列为空时返回false
+    ******************************************************/
+    bool pop(Item& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(buffer[h]);
+        head.store(next(h), std::memory_order_release);
+        return true;
+    }
+    bool isEmpty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+    size_t capacity() const {return buffer.size() - 1;}
+};
+#endif
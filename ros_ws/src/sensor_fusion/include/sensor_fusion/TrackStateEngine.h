@@ -0,0 +1,55 @@
+#ifndef TRACK_STATE_ENGINE_H
+#define TRACK_STATE_ENGINE_H
+#include "sensor_fusion/FusionTypes.h"
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#define KF_ACCEL_NOISE 2.0             // std of the white-noise acceleration, m/s^2
+#define KF_POSITION_NOISE 0.3          // std of the measured box center, meters
+#define KF_INITIAL_VELOCITY_STD 10.0   // std of the unknown velocity of a new track, m/s
+#define KF_GATE_CHI2 9.21              // chi-square gate of the 2 dof innovation, 99%
+#define TRACK_DEFAULT_DT 0.1           // frame period when no stamps are available (KITTI, 10 Hz), seconds
+
+/*************************************************************************
+*文件名：TrackStateEngine.h
+*功能：所有物体的鸟瞰图匀速运动模型卡尔曼滤波，按结构数组（SoA）存储。
+*状态为激光雷达坐标系下检测框中心的位置与速度（x, y, vx, vy），观测为三维检测框中心；
+*协方差对称，只存上三角的10个元素。观测矩阵为[I 0]，预测与更新展开为逐元素的标量运算，
+*对所有物体一次遍历，循环体无分支，便于编译器向量化。
+*物体按ID索引，删除时与最后一个槽位交换，数组始终紧凑
+**************************************************************************/
+class TrackStateEngine {
+private:
+    enum {SX = 0, SY, SVX, SVY, STATE_DIM};
+    enum {P00 = 0, P01, P02, P03, P11, P12, P13, P22, P23, P33, COV_DIM};
+    std::vector<float> state[STATE_DIM];
+    std::vector<float> cov[COV_DIM];
+    std::vector<float> meas_x;             // measurement pending for the next update sweep
+    std::vector<float> meas_y;
+    std::vector<float> meas_mask;          // 1 if the slot has a pending measurement, 0 otherwise
+    std::vector<char> initialized;
+    std::vector<int> ids;
+    std::unordered_map<int, size_t> slots;
+    void initSlot(const size_t slot, const float px, const float py);
+public:
+    size_t size() const {return ids.size();}
+    bool contains(const int ID) const {return slots.count(ID) != 0;}
+    bool add(const int ID);
+    bool remove(const int ID);
+    void clear();
+    void predict(const float dt);
+    void setMeasurement(const int ID, const float px, const float py);
+    void update();
+    bool isInitialized(const int ID) const;
+    float gateDistance(const int ID, const float px, const float py) const;
+    bool getPosition(const int ID, float &px, float &py) const;
+    bool getVelocity(const int ID, float &vx, float &vy) const;
+};
+/*****************************************************
+*功能：三维检测框是否由点云拟合得到，可作为滤波器的观测
+*****************************************************/
+inline bool has_position(const Box3d& box3d) {
+    return box3d.length > 0;
+}
+#endif
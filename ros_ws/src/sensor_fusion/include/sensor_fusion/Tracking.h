@@ -1,12 +1,10 @@
 #ifndef TRACKING_H
 #define TRACKING_H
 #include "sensor_fusion/detection_fusion.h"
+#include "sensor_fusion/TrackStateEngine.h"
+#include "sensor_fusion/BoxMetrics.h"
 #include "sensor_fusion/LinkList.hpp"
-#include "sensor_fusion/detection_fusion.h"
 #include <Eigen/Eigen>
-#include <opencv2/core/core.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
-#include <opencv2/highgui/highgui.hpp>
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <string>
@@ -22,6 +20,7 @@
 #define MIN_IoU 0.2
 #define MISSED_FRAME 4
 #define MAX_STATIC_FRAME 2
+#define DIMENSION_EMA_ALPHA 0.3     // weight of the newest fitted box in the smoothed dimensions
 
 typedef std::string string;
 typedef Eigen::Matrix<double, 3, 3> Matrix3d;
@@ -30,7 +29,9 @@ typedef Eigen::Matrix<double, 3, 1> Matrix31d;
 typedef Eigen::Matrix<double, 4, 2> Matrix42d;
 typedef Eigen::Matrix<double, 4, 4> Matrix4d;
 /*************************************************************************
-*功能：存储物体轨迹（有待修改）
+*功能：存储物体轨迹（有待修改）。历史中只保存检测框，不保存点云；
+*尺寸的最大值与指数平滑值在添加检测时以O(1)更新，
+*与历史长度无关，历史满MAX_FRAME帧后丢弃最早的一帧
 *************************************************************************/
 class Object : public LinkList<detection_cam> {
 private:
@@ -40,34 +41,49 @@ private:
     float tracking_length = 0;
     float tracking_width = 0;
     float tracking_height = 0;
+    float smoothed_length = 0;
+    float smoothed_width = 0;
+    float smoothed_height = 0;
+    size_t dimension_samples = 0;  // fitted boxes in the smoothed dimensions
     //static int trackNum;
     //static int nextID;
     bool setMotion();
 public:
     Object(int nextID, const int qs = MAX_FRAME) : LinkList<detection_cam>(qs), trackID(nextID) {motion = true; nonMotionFrame = 0;/* trackNum++; nextID++;*/}
-    Object(int nextID, detection_cam obj_det, const int qs = MAX_FRAME) : LinkList<detection_cam>(qs), trackID(nextID) {motion = true; nonMotionFrame = 0; addItem(obj_det); renewDimenstion();/* trackNum++; nextID++;*/}
+    Object(int nextID, const detection_cam& obj_det, const int qs = MAX_FRAME) : LinkList<detection_cam>(qs), trackID(nextID) {motion = true; nonMotionFrame = 0; addDetection(obj_det);/* trackNum++; nextID++;*/}
     ~Object() {/*trackNum--;*/};
     bool isMotion();
     void addNonMotion();
     int getTrackID();
-    bool renewDimenstion();
-    void getDimension(float &length_, float &width_, float &height_);
+    bool addDetection(const detection_cam& det);
+    bool renewDimenstion(const Box3d& box3d);
+    void getDimension(float &length_, float &width_, float &height_) const;
+    bool getSmoothedDimension(float &length_, float &width_, float &height_) const;
 };
 /*************************************************************************
-*功能：存储物体
+*功能：存储物体，物体的运动状态由engine统一存储与更新，随物体创建与删除
 *************************************************************************/
 class ObjectList : public LinkList<Object> {
 private:
+    TrackStateEngine engine;
 public:
     ObjectList(const int qs = MAX_OBJECT_IN_LIST) : LinkList<Object>(qs) {};
     //ObjectList(const int qs = 500) : LinkList<Object>(qs) {};
     ~ObjectList(){};
-    bool addTrack(const int ID, const detection_cam track);
+    bool addTrack(const int ID, const detection_cam& track);
+    bool newTrack(const int ID, const detection_cam& track);
     bool delID(const int ID);
+    void clear();
     int searchID(const int ID);
     Object* getObject(const int ID);
+    void predict(const float dt);
+    void update();
+    bool inGate(const int ID, const Box3d& box3d) const;
+    const TrackStateEngine& getEngine() const {return engine;}
 };
-void Hungaria(LinkList<detection_cam> detectPrev, LinkList<detection_cam>& detectCurr, ObjectList* objectList);
-double IoU(const Box2d prev_box, const Box2d curr_box);
+void Hungaria(LinkList<detection_cam> detectPrev, LinkList<detection_cam>& detectCurr, ObjectList* objectList,
+              const float dt = TRACK_DEFAULT_DT, const AssociationMetric metric = ASSOC_IOU_2D);
+double IoU(const Box2d& prev_box, const Box2d& curr_box);
 void renewBox3d(Box3d &box3d, const float length, const float width, const float height);
+bool renewBox3d(Box3d &box3d, const Object& object);
 #endif
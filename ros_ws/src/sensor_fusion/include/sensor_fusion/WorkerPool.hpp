@@ -0,0 +1,86 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*************************************************************************
+*文件名：WorkerPool.hpp
+*功能：固定数量的常驻线程，用于每帧都要执行的并行任务，避免逐帧创建线程。
+*run由同一个线程调用，调用线程也参与执行，所有任务完成后返回
+**************************************************************************/
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mtx;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    std::function<void(size_t)> task;
+    size_t task_count;
+    size_t next_task;
+    size_t pending;          // tasks not finished yet
+    bool stopping;
+    /*****************************************************
+    *功能：取出下一个任务的序号，没有剩余任务时返回false，调用时需持有mtx
+    ******************************************************/
+    bool take(size_t& i) {
+        if (next_task >= task_count) return false;
+        i = next_task++;
+        return true;
+    }
+    /*****************************************************
+    *功能：执行任务并在全部完成时唤醒run，调用时需持有lock
+    ******************************************************/
+    void execute(std::unique_lock<std::mutex>& lock, const size_t i) {
+        lock.unlock();
+        task(i);
+        lock.lock();
+        if (--pending == 0) done_cv.notify_all();
+    }
+    void work() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            start_cv.wait(lock, [this] {return stopping || next_task < task_count;});
+            if (stopping) return;
+            size_t i;
+            while (take(i)) execute(lock, i);
+        }
+    }
+public:
+    explicit WorkerPool(const size_t thread_num) : task_count(0), next_task(0), pending(0), stopping(false) {
+        for (size_t t = 0; t < thread_num; t++) threads.emplace_back(&WorkerPool::work, this);
+    }
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        start_cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool & operator = (const WorkerPool &) = delete;
+    size_t size() const {return threads.size();}
+    /*****************************************************
+    *功能：并行执行func(0) ... func(count-1)，全部完成后返回
+    *输入：
+    *count: 任务数
+    *func: 任务函数，参数为任务序号
+    ******************************************************/
+    void run(const size_t count, const std::function<void(size_t)>& func) {
+        if (!count) return;
+        std::unique_lock<std::mutex> lock(mtx);
+        task = func;
+        task_count = count;
+        next_task = 0;
+        pending = count;
+        start_cv.notify_all();
+        size_t i;
+        while (take(i)) execute(lock, i);
+        done_cv.wait(lock, [this] {return pending == 0;});
+    }
+};
+#endif
@@ -5,6 +5,8 @@
 ///////////////
 #include <string>
 #include <vector>
+#include <memory>
+#include <cstring>
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp/logger.hpp>
 
@@ -32,15 +34,14 @@
 #include <message_filters/synchronizer.h>
 #include <message_filters/sync_policies/approximate_time.h>
 #include <message_filters/sync_policies/exact_time.h>
+
+#include "sensor_fusion/PointCloudView.hpp"
+#include "sensor_fusion/FusionTypes.h"
 using namespace std::chrono_literals;
 //static int marker_id = 0;
 /////////////
 /// TYPES ///
 /////////////
-typedef std::vector<darknet_ros_msgs::msg::BoundingBox> Boxes2d;
-typedef std::vector<darknet_ros_msgs::msg::BoundingBox3d> Boxes3d;
-typedef darknet_ros_msgs::msg::BoundingBox Box2d;
-typedef darknet_ros_msgs::msg::BoundingBox3d Box3d;
 typedef std::string string;
 typedef message_filters::sync_policies::ApproximateTime
         <sensor_msgs::msg::PointCloud2,                 
@@ -53,42 +54,119 @@ typedef message_filters::Synchronizer<my_sync_policy> Sync;
 /////////////////
 /// FUNCTIONS ///
 /////////////////
-void draw_box(const sensor_msgs::msg::Image::SharedPtr& img_in, 
-              sensor_msgs::msg::Image::SharedPtr& img_out,
-              const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr& BBoxes_msg,
-              const int thickness);
-void rotateZ(geometry_msgs::msg::Point &p, float pos_x, float pos_y, float heading);
-void publish_point_cloud(rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr& pcl_pub, 
+inline std::unique_ptr<sensor_msgs::msg::Image> image_for_drawing(const sensor_msgs::msg::Image::SharedPtr& img_in, cv::Mat& canvas);
+inline void rotateZ(geometry_msgs::msg::Point &p, float pos_x, float pos_y, float heading);
+inline void publish_point_cloud(rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr& pcl_pub, 
                          pcl::PointCloud<pcl::PointXYZI>::Ptr cloud, std_msgs::msg::Header header);
-void publish_3d_box(rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr& box3d_pub, 
-                    const Box3d box3d, const std_msgs::msg::Header header, const int track_id);
+inline bool view_from_msg(const sensor_msgs::msg::PointCloud2& cloud_msg, PointCloudView& view);
+inline void boxes_from_msg(const darknet_ros_msgs::msg::BoundingBoxes& boxes_msg, Boxes2d& boxes);
 /*****************************************************
 *功能：在图像上绘制二维检测框
 *输入：
-*cv_ptr: 指向OpenCV格式的图像指针
+*image: OpenCV格式的图像，可直接指向待发布消息的缓冲区
 *box：二维检测结果
 *track_id：追踪得到的物体id，用于确定检测框颜色
 *****************************************************/
-void draw_box(cv_bridge::CvImageConstPtr& cv_ptr, 
-              const Box2d box, int track_id, const int thickness = 4) {
+inline void draw_box(cv::Mat& image, const Box2d& box, int track_id, const int thickness = 4) {
     int r[8] = {255,255,255,0,0,  0,  0  ,255};
     int g[8] = {0,  255,255,0,255,255,0  ,0};
     int b[8] = {0,  0,  255,0,0,  255,255,255};
-    cv::rectangle(cv_ptr->image, cv::Point(box.xmin,box.ymin), cv::Point(box.xmax,box.ymax), cv::Scalar(b[track_id%8],g[track_id%8],r[track_id%8]), thickness);
+    cv::rectangle(image, cv::Point(box.xmin,box.ymin), cv::Point(box.xmax,box.ymax), cv::Scalar(b[track_id%8],g[track_id%8],r[track_id%8]), thickness);
+}
+/*****************************************************
+*功能：生成用于绘制并发布的bgr8图像消息，绘制直接写入消息缓冲区
+*输入：
+*img_in: 订阅的图像消息
+*canvas: 指向输出消息缓冲区的OpenCV图像
+*输出：
+*待发布的图像消息，通过unique_ptr发布以便进程内订阅者免拷贝接收
+*****************************************************/
+inline std::unique_ptr<sensor_msgs::msg::Image> image_for_drawing(const sensor_msgs::msg::Image::SharedPtr& img_in, cv::Mat& canvas) {
+    std::unique_ptr<sensor_msgs::msg::Image> img_out(new sensor_msgs::msg::Image);
+    if (img_in->encoding == "bgr8") {
+        *img_out = *img_in;
+    } else {
+        cv_bridge::CvImageConstPtr cv_ptr = cv_bridge::toCvShare(img_in, "bgr8");
+        cv_bridge::CvImage(img_in->header, "bgr8", cv_ptr->image).toImageMsg(*img_out);
+    }
+    canvas = cv::Mat(img_out->height, img_out->width, CV_8UC3, img_out->data.data(), img_out->step);
+    return img_out;
 }
 /*****************************************************
-*功能：PCL格式点云转换为ros_msg格式点云并发布
+*功能：PCL格式点云直接写入预分配的ros_msg格式点云并发布
 *输入：
 *pcl_pub: 点云的发布
 *cloud: 指向pcl格式点云的指针
 *header: 将使用订阅点云的header用作处理后点云的header
+*说明：
+*字段布局与pcl::toROSMsg一致，整体拷贝点云缓冲区一次，
+*以unique_ptr发布以便进程内订阅者免序列化接收
 *****************************************************/
-void publish_point_cloud(rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr& pcl_pub, 
+inline void publish_point_cloud(rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr& pcl_pub, 
                          pcl::PointCloud<pcl::PointXYZI>::Ptr cloud, std_msgs::msg::Header header) {
-    sensor_msgs::msg::PointCloud2 cloud_msg;
-    pcl::toROSMsg(*cloud, cloud_msg);
-    cloud_msg.header = header;
-    pcl_pub->publish(cloud_msg);
+    std::unique_ptr<sensor_msgs::msg::PointCloud2> cloud_msg(new sensor_msgs::msg::PointCloud2);
+    pcl::PointXYZI p;
+    const char* names[4] = {"x", "y", "z", "intensity"};
+    const float* members[4] = {&p.x, &p.y, &p.z, &p.intensity};
+    cloud_msg->fields.resize(4);
+    for (int i = 0; i < 4; i++) {
+        cloud_msg->fields[i].name = names[i];
+        cloud_msg->fields[i].offset = reinterpret_cast<const uint8_t*>(members[i]) - reinterpret_cast<const uint8_t*>(&p);
+        cloud_msg->fields[i].datatype = sensor_msgs::msg::PointField::FLOAT32;
+        cloud_msg->fields[i].count = 1;
+    }
+    cloud_msg->header = header;
+    cloud_msg->height = 1;
+    cloud_msg->width = cloud->points.size();
+    cloud_msg->is_bigendian = false;
+    cloud_msg->is_dense = cloud->is_dense;
+    cloud_msg->point_step = sizeof(pcl::PointXYZI);
+    cloud_msg->row_step = cloud_msg->point_step * cloud_msg->width;
+    cloud_msg->data.resize(cloud_msg->row_step);
+    if (cloud_msg->row_step)
+        std::memcpy(cloud_msg->data.data(), cloud->points.data(), cloud_msg->row_step);
+    pcl_pub->publish(std::move(cloud_msg));
+}
+/*****************************************************
+*功能：不做转换，直接按字段偏移包装点云消息的缓冲区
+*输入：
+*cloud_msg: 点云消息，视图使用期间须保持有效
+*view: 用于储存点云视图
+*输出：
+*false: x/y/z不是主机字节序的float32字段，需要使用pcl::fromROSMsg
+*****************************************************/
+inline bool view_from_msg(const sensor_msgs::msg::PointCloud2& cloud_msg, PointCloudView& view) {
+    int64_t offset[4] = {-1, -1, -1, -1};
+    const char* names[4] = {"x", "y", "z", "intensity"};
+    for (const auto& field : cloud_msg.fields)
+        for (int i = 0; i < 4; i++)
+            if (field.name == names[i] && field.datatype == sensor_msgs::msg::PointField::FLOAT32 && field.count == 1)
+                offset[i] = field.offset;
+    if (cloud_msg.is_bigendian || offset[0] < 0 || offset[1] < 0 || offset[2] < 0) return false;
+    if (cloud_msg.data.size() < (size_t)cloud_msg.row_step * cloud_msg.height) return false;
+    view = PointCloudView(cloud_msg.data.data(), cloud_msg.width, cloud_msg.height,
+                          cloud_msg.point_step, cloud_msg.row_step,
+                          offset[0], offset[1], offset[2], offset[3]);
+    return true;
+}
+/*****************************************************
+*功能：二维检测消息转换为融合算法使用的检测框，类别名称只在此处解析一次
+*输入：
+*boxes_msg: 订阅的二维检测结果
+*boxes: 用于储存检测框
+*****************************************************/
+inline void boxes_from_msg(const darknet_ros_msgs::msg::BoundingBoxes& boxes_msg, Boxes2d& boxes) {
+    boxes.resize(boxes_msg.bounding_boxes.size());
+    for (size_t i = 0; i < boxes.size(); i++) {
+        const darknet_ros_msgs::msg::BoundingBox& box_msg = boxes_msg.bounding_boxes[i];
+        boxes[i].probability = box_msg.probability;
+        boxes[i].xmin = box_msg.xmin;
+        boxes[i].ymin = box_msg.ymin;
+        boxes[i].xmax = box_msg.xmax;
+        boxes[i].ymax = box_msg.ymax;
+        boxes[i].id = box_msg.id;
+        boxes[i].obj_class = box_class_from_name(box_msg.obj_class.c_str());
+    }
 }
 /*****************************************************
 *功能：绕z轴的旋转矩阵
@@ -98,7 +176,7 @@ void publish_point_cloud(rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::Share
 *pox_y: 旋转轴的y坐标
 *heading：绕z轴的旋转角
 *****************************************************/
-void rotateZ(geometry_msgs::msg::Point &p, float pos_x, float pos_y, float heading) {
+inline void rotateZ(geometry_msgs::msg::Point &p, float pos_x, float pos_y, float heading) {
     float x = p.x;
     float y = p.y;
     p.x = (x-pos_x)*cos(heading) - (y-pos_y)*sin(heading) + pos_x;
@@ -113,7 +191,7 @@ void rotateZ(geometry_msgs::msg::Point &p, float pos_x, float pos_y, float headi
 *track_id: 用作maker的id，决定marker的颜色和存续时长
 *miss: 该检测结果是否存在于当前帧
 *****************************************************/
-void publish_3d_box(rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr& box3d_pub, const Box3d box3d, const std_msgs::msg::Header header, const int track_id, bool miss) {
+inline void publish_3d_box(rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr& box3d_pub, const Box3d& box3d, const std_msgs::msg::Header header, const int track_id, bool miss) {
     visualization_msgs::msg::Marker bbox_marker;
     bbox_marker.id = track_id;
     bbox_marker.header = header;
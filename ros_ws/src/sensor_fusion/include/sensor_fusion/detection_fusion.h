@@ -1,14 +1,19 @@
 #ifndef DETECTION_FUSION_H
 #define DETECTION_FUSION_H
 #include "LinkList.hpp"
+#include "PointCloudView.hpp"
+#include "FusionTypes.h"
+#include "SensorProfile.h"
 
 #include <string>
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <map>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <unordered_set>
 
 #include <Eigen/Eigen>
@@ -22,36 +27,8 @@
 #include <pcl/segmentation/conditional_euclidean_clustering.h>
 #include <pcl/filters/statistical_outlier_removal.h>
 
-#include <cv_bridge/cv_bridge.h>
-#include <opencv2/core/core.hpp>
-#include <opencv2/imgproc/imgproc.hpp>
-#include <opencv2/highgui/highgui.hpp>
-
-#include <rclcpp/rclcpp.hpp>
-#include <geometry_msgs/msg/point.hpp>
-#include <visualization_msgs/msg/marker.hpp>
-
-#include "darknet_ros_msgs/msg/bounding_box.hpp"
-#include "darknet_ros_msgs/msg/bounding_boxes.hpp"
-#include "darknet_ros_msgs/msg/bounding_box3d.hpp"
-#include "darknet_ros_msgs/msg/bounding_boxes3d.hpp"
-
-
-
-// Calculation of 2d-box
-#define IMG_LENGTH 1242
-#define IMG_WIDTH 375
-
-#define IOU_THRESHOLD 0.01
-
-
-
-#define S_GROUP_THRESHOLD 10
-#define S_GROUP_REFINED_THRESHOLD 5
-// L-shape Fitting Proposal Params
-#define ANGLE_RESO 0.06
-#define POINT_NUM 5
-#define MIN_SLOPE 0.0000001
+// Cross-camera de-duplication
+#define DEDUP_OVERLAP_RATIO 0.5
 typedef std::string string;
 typedef Eigen::Matrix<double, 3, 4> Matrix34d;
 typedef Eigen::Matrix<double, 3, 3> Matrix3d;
@@ -61,13 +38,10 @@ typedef Eigen::Matrix<float, 4, 4> Matrix4f;
 typedef Eigen::Matrix<float, 2, 2> Matrix2f;
 typedef Eigen::Matrix<float, 5, 1> Matrix51f;
 
-typedef std::vector<darknet_ros_msgs::msg::BoundingBox> Boxes2d;
-typedef std::vector<darknet_ros_msgs::msg::BoundingBox3d> Boxes3d;
-typedef darknet_ros_msgs::msg::BoundingBox Box2d;
-typedef darknet_ros_msgs::msg::BoundingBox3d Box3d;
 struct detection_cam {
     int id = 0;
     int miss = 0;
+    bool duplicate = false;     // same object already fused from another camera
     bool far = false;
     float distance_far = 0;
     Box2d box;
@@ -97,7 +71,19 @@ struct Point2D {
     float y = 0;
 };
 typedef std::vector<PointXYZIRT> PointCloudXYZIRT;
-class detection_fusion {
+/*************************************************************************
+*功能：点云在某个相机图像平面上的投影，序号与点云一致
+*************************************************************************/
+struct CloudProjection {
+    std::vector<Point2D> uv;        // image coordinates
+    std::vector<char> valid;        // point lies in front of the near plane, uv is meaningful
+};
+class PreprocessedCloud;
+/*************************************************************************
+*功能：单帧二维检测与点云的视锥融合，按rig参数（见SensorProfile.h）实例化
+*************************************************************************/
+template<typename Rig>
+class BasicDetectionFusion {
 private:
     Boxes2d boxes2d;
     Boxes2d objs2d;
@@ -111,17 +97,25 @@ private:
     std::vector<std::vector<size_t>> group_sorted;
     bool is_initialized;
     pcl::PointCloud<pcl::PointXYZI>::Ptr inCloud;
+    std::shared_ptr<const CloudProjection> projection;   // inCloud projected once per frame, beyond Rig::frustum_near
+    void initialize_calibration(const Matrix34d& P, const Matrix3d& R, const Matrix31d& T);
     
 public:
-    detection_fusion();
-    ~detection_fusion();
+    BasicDetectionFusion();
+    ~BasicDetectionFusion();
     void Initialize(LinkList<detection_cam> &DetectFrame, 
-                    const darknet_ros_msgs::msg::BoundingBoxes::ConstPtr& BBoxes_msg,
-                    const darknet_ros_msgs::msg::BoundingBoxes::ConstPtr& Objs_msg,
+                    const Boxes2d& BBoxes,
+                    const Boxes2d& Objs,
                     const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_,
                     const Matrix34d P, const Matrix3d R, const Matrix31d T);
+    void Initialize(LinkList<detection_cam> &DetectFrame, 
+                    const Boxes2d& BBoxes,
+                    const Boxes2d& Objs,
+                    PreprocessedCloud& cloud,
+                    const Matrix34d P, const Matrix3d R, const Matrix31d T);
     bool Is_initialized();
     void initialize_list();
+    void project_cloud(const PointCloudView &in_view);
     void extract_feature();
     void occlusion_table_calc();
     void seperate_into_group();
@@ -132,11 +126,11 @@ public:
                     const pcl::PointIndices fruIndices,
                     pcl::PointCloud<pcl::PointXYZI>::Ptr cloud_cluster,
                     pcl::PointIndices& objIndices);
-    void clip_frustum(const Box2d box2d, pcl::PointCloud<pcl::PointXYZI>::Ptr &outCloud, pcl::PointIndices& fruIndices);
+    void clip_frustum(const Box2d& box2d, pcl::PointCloud<pcl::PointXYZI>::Ptr &outCloud, pcl::PointIndices& fruIndices);
     void clip_frustum_with_overlap(const size_t num, pcl::PointCloud<pcl::PointXYZI>::Ptr &outCloud, pcl::PointIndices& fruIndices);
-    bool in_frustum(const double u, const double v, const Box2d box);
+    bool in_frustum(const double u, const double v, const Box2d& box);
     bool in_frustum_overlap(const size_t cloud_indice, const size_t num);
-    Box2d overlap_box(const Box2d prev_box, const Box2d curr_box);
+    Box2d overlap_box(const Box2d& prev_box, const Box2d& curr_box);
     double Lshape(pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrCarCloud,
                   pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrSgroup,
                   Matrix51f &u);
@@ -144,8 +138,8 @@ public:
     double Lfit(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud, Matrix51f &u);
     Matrix4f deltaM_compute(const pcl::PointXYZI point);
     void bounding_box_param(const Matrix51f u, const pcl::PointCloud<pcl::PointXYZI>::Ptr ptrSgroup, 
-                            const pcl::PointCloud<pcl::PointXYZI>::Ptr carCloud, Box3d& box3d, const Box2d box);
-    bool box_point_estimation(const Matrix51f u, const Point2D corner_point, const Box2d box, 
+                            const pcl::PointCloud<pcl::PointXYZI>::Ptr carCloud, Box3d& box3d, const Box2d& box);
+    bool box_point_estimation(const Matrix51f u, const Point2D corner_point, const Box2d& box, 
                               Point2D &point_1, Point2D &point_2);
     bool line_intersection(const float k1, const float b1, const float k2, const float b2, Point2D &point);
     void uv_projection_into_xy(const float u, const float v, float &slope, float &b);
@@ -159,7 +153,13 @@ public:
     void add_to_group(const std::vector<std::vector<bool>> occlusion_table, const int start, std::unordered_set<size_t>& group_set);
     Boxes2d get_boxes();
 };
-bool IoU_bool(const Box2d prev_box, const Box2d curr_box);
+typedef BasicDetectionFusion<KittiRig> detection_fusion;
+template<typename Rig>
+bool IoU_bool(const Box2d& prev_box, const Box2d& curr_box);
 bool customRegionGrowing(const pcl::PointXYZINormal& point_a, const pcl::PointXYZINormal& point_b, float squared_distance);
+bool read_calibration(const string& file_name, Matrix34d& P, Matrix3d& R, Matrix31d& T);
+void project_into_image(const PointCloudView &in_view, const Matrix34d& point_projection_matrix, const double near,
+                        CloudProjection& out_projection);
+size_t mark_cross_camera_duplicates(const std::vector<LinkList<detection_cam>*>& camera_frames, const size_t cloud_size);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,151 @@
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+#include "sensor_fusion/data_utils.hpp"
+#include "sensor_fusion/GroundRemove.h"
+#include "sensor_fusion/CloudCache.h"
+#include "sensor_fusion/Tracking.h"
+#include "sensor_fusion/SpscQueue.hpp"
+#include "sensor_fusion/ResultLogger.h"
+#include "sensor_fusion/Profiler.h"
+#include "sensor_fusion/WorkerPool.hpp"
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
+#include <rclcpp/rclcpp.hpp>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#define PIPELINE_QUEUE_SIZE 4
+#define PROFILE_PERIOD_MS 1000     // period of the diagnostics message
+#define MAX_PENDING_FRAMES 4       // clouds waiting for the rest of their cameras before going out incomplete
+#define CAMERA_TIMEOUT_MS 200      // a cloud this much older than the newest one stops waiting for missing cameras
+#define RECENT_STAMPS 16           // stamps remembered as handled, a late camera part of one is not acknowledged again
+#define DEFAULT_CALIBRATION_FILE "/home/kiki/data/kitti/calibration.txt"
+
+/*************************************************************************
+*功能：单个相机在一帧中的数据，各阶段依次填充
+*************************************************************************/
+struct CameraFrame {
+    bool received;                                          // ingest, false if the camera missed this cloud
+    sensor_msgs::msg::Image::SharedPtr img_msg;
+    Boxes2d det_boxes;                                      // ingest, converted from the detection messages
+    Boxes2d obj_boxes;
+    LinkList<detection_cam> detectFrame;                    // fusion stage, ids filled by tracking stage
+    Boxes2d overlap_boxes;                                  // fusion stage
+    CameraFrame() : received(false), detectFrame(MAX_DETECT_PER_FRAME) {}
+};
+/*************************************************************************
+*功能：流水线中传递的单帧数据，一帧点云与各相机的图像与检测结果
+*************************************************************************/
+struct FusionFrame {
+    size_t index;
+    std::chrono::steady_clock::time_point ingest_time;
+    sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg;
+    std::vector<CameraFrame> cameras;
+    size_t received_cameras;
+    bool restart;                                          // ingest, stamps went backwards, stages drop their temporal state
+    PreprocessedCloudPtr preprocessed;                     // ground stage, shared through CloudCache
+    pcl::PointCloud<pcl::PointXYZI>::Ptr groundOffCloud;   // ground stage, points of preprocessed
+    explicit FusionFrame(const size_t camera_num) : index(0), cameras(camera_num), received_cameras(0), restart(false) {}
+};
+typedef std::unique_ptr<FusionFrame> FusionFramePtr;
+typedef SpscQueue<FusionFramePtr> FrameQueue;
+
+//////////////////
+/// NODE CLASS ///
+//////////////////
+class SensorFusion : public rclcpp::Node {
+public:
+    explicit SensorFusion(const rclcpp::NodeOptions& options = rclcpp::NodeOptions());
+    ~SensorFusion();
+
+private:
+    size_t callback_count;
+    GroundModel groundModel;
+    bool use_ground_model;
+    AssociationMetric association_metric;
+    struct calibration {
+        Matrix34d P;
+        Matrix3d R;
+        Matrix31d T;
+    };
+    /*************************************************************************
+    *功能：单个相机的订阅、标定与跟踪状态。每个相机的图像与检测结果和共用的点云订阅单独同步
+    *************************************************************************/
+    struct CameraStream {
+        SensorFusion* node;
+        size_t index;
+        string name;
+        calibration calib;
+        message_filters::Subscriber<sensor_msgs::msg::Image> img_sub;
+        message_filters::Subscriber<darknet_ros_msgs::msg::BoundingBoxes> det_sub;
+        message_filters::Subscriber<darknet_ros_msgs::msg::BoundingBoxes> obj_sub;
+        std::shared_ptr<Sync> sync_;
+        rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr img_pub;
+        ObjectList carList;                                 // tracking stage
+        LinkList<detection_cam> detectPrev;                 // tracking stage, previous frame of this camera
+        int64_t prev_stamp;                                 // tracking stage, stamp of detectPrev in nanoseconds
+        CameraStream(SensorFusion* node_, const size_t index_) : node(node_), index(index_),
+            carList(MAX_OBJECT_IN_LIST), detectPrev(MAX_DETECT_PER_FRAME), prev_stamp(-1) {}
+        void sync_callback(const sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg,
+                           const sensor_msgs::msg::Image::SharedPtr img_msg,
+                           const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr det_msg,
+                           const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr obj_msg);
+    };
+    std::vector<std::unique_ptr<CameraStream>> cameras;
+
+    message_filters::Subscriber<sensor_msgs::msg::PointCloud2> pcl_sub;
+    //message_filters::Subscriber<sensor_msgs::msg::NavSatFix> gps_sub;
+    //message_filters::Subscriber<sensor_msgs::msg::Imu> imu_sub;
+
+    // Initialize publishers
+    rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pcl_pub_car;
+    rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pcl_pub;
+    rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr box3d_pub;
+    // header of every finished or dropped frame, used by kitti_pub for back-pressure
+    rclcpp::Publisher<std_msgs::msg::Header>::SharedPtr frame_done_pub;
+    rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr diagnostics_pub;
+    rclcpp::TimerBase::SharedPtr diagnostics_timer;
+    string profile_csv;
+    void publish_diagnostics();
+
+    string point_cloud_topic;
+    std::unique_ptr<ResultLogger> resultLogger;
+    rcl_interfaces::msg::SetParametersResult on_parameters_set(const std::vector<rclcpp::Parameter>& parameters);
+    void init_cameras();
+    bool get_calibration(const string& file_name, calibration& calib);
+
+    // Assembly of the per-camera parts of a cloud, keyed by the cloud stamp in nanoseconds
+    std::mutex assembly_mtx;
+    std::map<int64_t, FusionFramePtr> pending_frames;
+    int64_t last_submitted_stamp;
+    int64_t camera_timeout;                                 // nanoseconds of cloud stamp
+    std::deque<int64_t> handled_stamps;                     // submitted, dropped or rejected lately
+    bool restart_pending;                                   // the next submitted frame starts a new sequence
+    void restart_sequence(const int64_t stamp);
+    void camera_callback(const size_t camera,
+                         const sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg,
+                         const sensor_msgs::msg::Image::SharedPtr img_msg,
+                         const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr det_msg,
+                         const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr obj_msg);
+    void submit_frame(FusionFramePtr& frame);
+
+    // Pipeline: ingest (camera_callback) -> ground -> fusion -> tracking -> output, one thread per stage
+    std::atomic<bool> running;
+    std::unique_ptr<FrameQueue> ground_queue;
+    std::unique_ptr<FrameQueue> fusion_queue;
+    std::unique_ptr<FrameQueue> tracking_queue;
+    std::unique_ptr<FrameQueue> output_queue;
+    std::vector<std::thread> stage_threads;
+    std::unique_ptr<WorkerPool> fusion_workers;             // fusion stage, one thread per camera after the first
+    size_t dropped_frames;
+    void run_stage(FrameQueue* in, FrameQueue* out, void (SensorFusion::*process)(FusionFrame&));
+    void ground_stage(FusionFrame& frame);
+    void fusion_stage(FusionFrame& frame);
+    void tracking_stage(FusionFrame& frame);
+    void output_stage(FusionFrame& frame);
+};
+#endif
@@ -0,0 +1,50 @@
+from ament_index_python.packages import get_package_share_directory
+import launch
+import launch.actions
+import launch.substitutions
+import launch_ros.actions
+import launch_ros.descriptions
+import os.path
+
+# Loads kitti_pub and sensor_fusion into one component container with intra-process
+# communication, so point clouds and images are handed over without serialization.
+def generate_launch_description():
+    rviz_config_dir = os.path.join(get_package_share_directory('sensor_fusion'), 'config', 'fusion.rviz')
+    para_dir = os.path.join(get_package_share_directory('sensor_fusion'), 'config', 'sensor_fusion_subscribed_topic.yaml')
+    return launch.LaunchDescription([
+        launch.actions.DeclareLaunchArgument(
+            'node_prefix',
+            default_value=[launch.substitutions.EnvironmentVariable('USER'), '.'],
+            description='Prefix for node names'
+        ),
+        launch_ros.actions.Node(
+            package='rviz2',
+            node_namespace='rviz2',
+            node_executable='rviz2',
+            arguments=['-d', rviz_config_dir]
+        ),
+        launch_ros.actions.ComposableNodeContainer(
+            package='rclcpp_components',
+            node_namespace='',
+            node_name='fusion_container',
+            node_executable='component_container',
+            composable_node_descriptions=[
+                launch_ros.descriptions.ComposableNode(
+                    package='kitti_pub',
+                    node_plugin='KittiPublisher',
+                    node_namespace='kitti_pub',
+                    node_name='kitti_node',
+                    extra_arguments=[{'use_intra_process_comms': True}]
+                ),
+                launch_ros.descriptions.ComposableNode(
+                    package='sensor_fusion',
+                    node_plugin='SensorFusion',
+                    node_namespace='sensor_fusion',
+                    node_name='sensor_fusion',
+                    parameters=[para_dir],
+                    extra_arguments=[{'use_intra_process_comms': True}]
+                )
+            ],
+            output='screen'
+        )
+    ])
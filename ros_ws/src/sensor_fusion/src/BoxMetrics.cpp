@@ -0,0 +1,112 @@
+#include "sensor_fusion/BoxMetrics.h"
+#include <cmath>
+
+#define BEV_MAX_VERTICES 16            // a quad clipped by 4 half-planes has at most 8 vertices, one spare slot per write
+
+/*****************************************************
+*功能：关联代价名称与枚举之间的转换
+*****************************************************/
+bool association_metric_from_name(const std::string& name, AssociationMetric& metric) {
+    for (int i = 0; i < ASSOC_METRIC_COUNT; i++)
+        if (name == association_metric_name((AssociationMetric)i)) {metric = (AssociationMetric)i; return true;}
+    return false;
+}
+const char* association_metric_name(const AssociationMetric metric) {
+    static const char* names[ASSOC_METRIC_COUNT] = {"iou_2d", "bev_iou", "center_distance"};
+    return names[metric];
+}
+/*****************************************************
+*功能：三维检测框在鸟瞰图下的四个角点，逆时针排列
+*****************************************************/
+static void bev_corners(const Box3d& box3d, float (&x)[4], float (&y)[4]) {
+    const float c = std::cos(box3d.heading), s = std::sin(box3d.heading);
+    const float lx = box3d.length / 2 * c, ly = box3d.length / 2 * s;
+    const float wx = -box3d.width / 2 * s, wy = box3d.width / 2 * c;
+    x[0] = box3d.pos.x + lx + wx; y[0] = box3d.pos.y + ly + wy;
+    x[1] = box3d.pos.x - lx + wx; y[1] = box3d.pos.y - ly + wy;
+    x[2] = box3d.pos.x - lx - wx; y[2] = box3d.pos.y - ly - wy;
+    x[3] = box3d.pos.x + lx - wx; y[3] = box3d.pos.y + ly - wy;
+}
+/*****************************************************
+*功能：三维检测框在鸟瞰图下的外接矩形，用于网格登记
+*****************************************************/
+void bev_extent(const Box3d& box3d, float &xmin, float &ymin, float &xmax, float &ymax) {
+    const float c = std::abs(std::cos(box3d.heading)), s = std::abs(std::sin(box3d.heading));
+    const float dx = (box3d.length * c + box3d.width * s) / 2;
+    const float dy = (box3d.length * s + box3d.width * c) / 2;
+    xmin = box3d.pos.x - dx; xmax = box3d.pos.x + dx;
+    ymin = box3d.pos.y - dy; ymax = box3d.pos.y + dy;
+}
+/*****************************************************
+*功能：用有向直线（e0到e1，左侧为内侧）裁剪凸多边形（Sutherland-Hodgman）。
+*每个顶点总是写入输出，是否保留由计数器的增量决定，循环内没有分支
+*输入：
+*in_x/in_y/in_n: 输入多边形
+*out_x/out_y: 输出多边形
+*输出：
+*输出多边形的顶点数
+*****************************************************/
+static int clip_half_plane(const float* in_x, const float* in_y, const int in_n,
+                           const float e0x, const float e0y, const float e1x, const float e1y,
+                           float* out_x, float* out_y) {
+    const float ex = e1x - e0x, ey = e1y - e0y;
+    int out_n = 0;
+    for (int i = 0; i < in_n; i++) {
+        const int j = (i + 1) % in_n;
+        const float di = ex * (in_y[i] - e0y) - ey * (in_x[i] - e0x);
+        const float dj = ex * (in_y[j] - e0y) - ey * (in_x[j] - e0x);
+        const int inside_i = di >= 0, inside_j = dj >= 0;
+        // keep the vertex if inside
+        out_x[out_n] = in_x[i];
+        out_y[out_n] = in_y[i];
+        out_n += inside_i;
+        // add the intersection if the edge crosses the line
+        const float denom = di - dj;
+        const float t = denom != 0 ? di / denom : 0;
+        out_x[out_n] = in_x[i] + t * (in_x[j] - in_x[i]);
+        out_y[out_n] = in_y[i] + t * (in_y[j] - in_y[i]);
+        out_n += inside_i ^ inside_j;
+    }
+    return out_n;
+}
+/*****************************************************
+*功能：两个三维检测框在鸟瞰图下的旋转矩形IoU。
+*外接圆不相交时直接返回0，否则以b的四条边依次裁剪a，再按鞋带公式求交集面积
+*输入：
+*box_a/box_b: 三维检测框
+*输出：
+*IoU数值，任一检测框面积为0时为0
+*****************************************************/
+float bev_iou(const Box3d& box_a, const Box3d& box_b) {
+    const float area_a = box_a.length * box_a.width, area_b = box_b.length * box_b.width;
+    if (area_a <= 0 || area_b <= 0) return 0;
+    const float radius_sum = (std::sqrt(box_a.length * box_a.length + box_a.width * box_a.width) +
+                              std::sqrt(box_b.length * box_b.length + box_b.width * box_b.width)) / 2;
+    if (center_distance(box_a, box_b) >= radius_sum) return 0;
+
+    float ax[4], ay[4], bx[4], by[4];
+    bev_corners(box_a, ax, ay);
+    bev_corners(box_b, bx, by);
+    float px[2][BEV_MAX_VERTICES], py[2][BEV_MAX_VERTICES];
+    int n = 4;
+    for (int i = 0; i < 4; i++) {px[0][i] = ax[i]; py[0][i] = ay[i];}
+    for (int e = 0; e < 4 && n > 0; e++) {
+        const int f = (e + 1) % 4;
+        n = clip_half_plane(px[e % 2], py[e % 2], n, bx[e], by[e], bx[f], by[f], px[(e + 1) % 2], py[(e + 1) % 2]);
+    }
+    if (n < 3) return 0;
+    // all four clips ran, the result is in buffer 0
+    float twice_area = 0;
+    for (int i = 0; i < n; i++) {
+        const int j = (i + 1) % n;
+        twice_area += px[0][i] * py[0][j] - px[0][j] * py[0][i];
+    }
+    const float inter = std::abs(twice_area) / 2;
+    return inter / (area_a + area_b - inter);
+}
+/*****************************************************
+*功能：两个三维检测框中心在鸟瞰图下的距离，米
+*****************************************************/
+float center_distance(const Box3d& box_a, const Box3d& box_b) {
+    return std::hypot(box_a.pos.x - box_b.pos.x, box_a.pos.y - box_b.pos.y);
+}
@@ -0,0 +1,105 @@
+#include "sensor_fusion/CloudCache.h"
+#include <algorithm>
+
+/*****************************************************
+*功能：地面去除后点云在某个标定下的图像投影，相同标定只计算一次
+*输入：
+*point_projection_matrix: 激光雷达坐标到图像齐次坐标的投影矩阵
+*near: 激光雷达x轴上小于该距离的点不投影
+*****************************************************/
+std::shared_ptr<const CloudProjection> PreprocessedCloud::projection(const Matrix34d& point_projection_matrix, const double near) {
+    std::array<double, 13> key;
+    for (int i = 0; i < 12; i++) key[i] = point_projection_matrix(i / 4, i % 4);
+    key[12] = near;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& cached : projections)
+            if (cached.key == key) return cached.projection;
+    }
+    // cameras with different calibrations project in parallel
+    std::shared_ptr<CloudProjection> cloud_projection(new CloudProjection);
+    project_into_image(PointCloudView(*groundOffCloud), point_projection_matrix, near, *cloud_projection);
+    std::lock_guard<std::mutex> lock(mtx);
+    for (const auto& cached : projections)
+        if (cached.key == key) return cached.projection;
+    projections.push_back(CachedProjection{key, cloud_projection});
+    return cloud_projection;
+}
+
+CloudCache& CloudCache::instance() {
+    static CloudCache cache;
+    return cache;
+}
+/*****************************************************
+*功能：逐出时间戳最早的帧直到不超过容量，调用时需持有锁
+*****************************************************/
+void CloudCache::evict() {
+    while (entries.size() > capacity) {
+        auto oldest = entries.begin();
+        for (auto it = entries.begin(); it != entries.end(); it++)
+            if (std::get<1>(it->first) < std::get<1>(oldest->first)) oldest = it;
+        entries.erase(oldest);
+    }
+}
+/*****************************************************
+*功能：请求缓存至少保留frames帧。多个消费者共用缓存，容量只增不减，
+*没有消费者请求时（容量为0）不保留任何帧
+*****************************************************/
+void CloudCache::reserve(const size_t frames) {
+    std::lock_guard<std::mutex> lock(mtx);
+    capacity = std::max(capacity, frames);
+}
+/*****************************************************
+*功能：按点云坐标系与时间戳查找预处理点云
+*输入：
+*source: 点云的坐标系（frame_id），区分不同的激光雷达
+*stamp: 点云的时间戳，纳秒
+*mode: 地面去除方式，不同方式的结果不互相替代
+*输出：
+*缓存中的预处理点云，不存在时为空
+*****************************************************/
+PreprocessedCloudPtr CloudCache::find(const std::string& source, const int64_t stamp, const GroundMode mode) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(Key(source, stamp, mode));
+    if (it == entries.end()) {misses++; return nullptr;}
+    hits++;
+    return it->second;
+}
+/*****************************************************
+*功能：插入一帧预处理点云，超出容量时逐出时间戳最早的帧
+*输入：
+*source: 点云的坐标系（frame_id）
+*stamp: 点云的时间戳，纳秒
+*mode: 地面去除方式
+*ground_off: 地面去除后的点云，插入后不再修改
+*ground_sectors: 处理该帧后的扇区地面模型，供命中缓存的消费者更新自己的模型
+*输出：
+*缓存中的预处理点云；其他消费者已插入同一帧时返回已有的条目
+*****************************************************/
+PreprocessedCloudPtr CloudCache::insert(const std::string& source, const int64_t stamp, const GroundMode mode,
+                                        const pcl::PointCloud<pcl::PointXYZI>::Ptr ground_off,
+                                        const std::shared_ptr<const GroundSectors> ground_sectors) {
+    PreprocessedCloudPtr cloud(new PreprocessedCloud(stamp, ground_off, ground_sectors));
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!capacity) return cloud;
+    auto inserted = entries.insert(std::make_pair(Key(source, stamp, mode), cloud));
+    if (!inserted.second) return inserted.first->second;
+    evict();
+    return cloud;
+}
+void CloudCache::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+}
+size_t CloudCache::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return entries.size();
+}
+/*****************************************************
+*功能：查找命中与未命中的累计次数
+*****************************************************/
+void CloudCache::stats(size_t& hits_, size_t& misses_) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    hits_ = hits;
+    misses_ = misses;
+}
@@ -0,0 +1,269 @@
+#include "sensor_fusion/FrameRecord.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*****************************************************
+*功能：在缓冲区末尾追加一段数据
+******************************************************/
+static void append_bytes(std::vector<char>& buffer, const void* data, const size_t size) {
+    if (!size) return;
+    size_t offset = buffer.size();
+    buffer.resize(offset + size);
+    std::memcpy(&buffer[offset], data, size);
+}
+
+/*****************************************************
+*功能：在缓冲区末尾追加点云的x/y/z
+******************************************************/
+static void append_cloud(std::vector<char>& buffer, const pcl::PointCloud<pcl::PointXYZI>& cloud) {
+    size_t offset = buffer.size();
+    buffer.resize(offset + cloud.points.size() * 3 * sizeof(float));
+    float* out = reinterpret_cast<float*>(&buffer[offset]);
+    for (auto it = cloud.points.begin(); it != cloud.points.end(); it++) {
+        *out++ = it->x;
+        *out++ = it->y;
+        *out++ = it->z;
+    }
+}
+
+/*****************************************************
+*功能：将一帧中未丢失的检测结果序列化并追加到缓冲区末尾
+*输入：
+*buffer: 用于储存记录的缓冲区
+*frame: 帧序号
+*stamp: 点云时间戳，纳秒
+*detections: 单帧检测结果
+******************************************************/
+void append_frame_record(std::vector<char>& buffer, const uint64_t frame, const int64_t stamp,
+                         LinkList<detection_cam>& detections) {
+    size_t start = buffer.size();
+    FrameRecordHeader header;
+    header.magic = FRAME_RECORD_MAGIC;
+    header.size = 0;
+    header.frame = frame;
+    header.stamp = stamp;
+    header.box_count = 0;
+    header.point_count = 0;
+    append_bytes(buffer, &header, sizeof(header));
+
+    std::vector<detection_cam*> logged;
+    for (size_t j = 0; j < detections.count(); j++) {
+        detection_cam* ptr_detect = detections.getPtrItem(j);
+        if (ptr_detect->miss) continue;
+        BoxRecord box;
+        box.id = ptr_detect->id;
+        box.slot = j;
+        box.box2d[0] = (ptr_detect->box.xmax + ptr_detect->box.xmin) / 2.0;
+        box.box2d[1] = (ptr_detect->box.ymax + ptr_detect->box.ymin) / 2.0;
+        box.box2d[2] = ptr_detect->box.xmax - ptr_detect->box.xmin;
+        box.box2d[3] = ptr_detect->box.ymax - ptr_detect->box.ymin;
+        box.box3d[0] = ptr_detect->box3d.pos.x;
+        box.box3d[1] = ptr_detect->box3d.pos.y;
+        box.box3d[2] = ptr_detect->box3d.pos.z;
+        box.box3d[3] = ptr_detect->box3d.length;
+        box.box3d[4] = ptr_detect->box3d.width;
+        box.box3d[5] = ptr_detect->box3d.height;
+        box.box3d[6] = ptr_detect->box3d.heading;
+        box.fru_count = ptr_detect->fruCloud.points.size();
+        box.sur_count = ptr_detect->surCloud.points.size();
+        box.car_count = ptr_detect->CarCloud.points.size();
+        box.index_count = ptr_detect->indices.indices.size();
+        append_bytes(buffer, &box, sizeof(box));
+        header.box_count++;
+        header.point_count += box.fru_count + box.sur_count + box.car_count;
+        logged.push_back(ptr_detect);
+    }
+    for (auto it = logged.begin(); it != logged.end(); it++) {
+        append_cloud(buffer, (*it)->fruCloud);
+        append_cloud(buffer, (*it)->surCloud);
+        append_cloud(buffer, (*it)->CarCloud);
+    }
+    for (auto it = logged.begin(); it != logged.end(); it++) {
+        const std::vector<int>& indices = (*it)->indices.indices;
+        append_bytes(buffer, indices.data(), indices.size() * sizeof(int32_t));
+    }
+
+    header.size = buffer.size() - start;
+    std::memcpy(&buffer[start], &header, sizeof(header));
+}
+
+/*****************************************************
+*功能：创建文件并写入索引为空的文件头
+*输入：
+*path: 文件路径，已存在时被覆盖
+*****************************************************/
+bool FrameRecordWriter::open(const std::string& path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    FrameFileHeader header;
+    header.magic = FRAME_FILE_MAGIC;
+    header.version = FRAME_FILE_VERSION;
+    header.frame_count = 0;
+    header.index_offset = 0;
+    header.reserved = 0;
+    offset = fwrite(&header, 1, sizeof(header), file);
+    index.clear();
+    return offset == sizeof(header);
+}
+/*****************************************************
+*功能：写入若干条完整的帧记录并登记到帧索引
+*输入：
+*records: 由append_frame_record生成的连续帧记录
+*size: 字节数
+*输出：实际写入的字节数
+*****************************************************/
+size_t FrameRecordWriter::append(const char* records, const size_t size) {
+    if (!file) return 0;
+    size_t written = fwrite(records, 1, size, file);
+    for (size_t pos = 0; pos + sizeof(FrameRecordHeader) <= written; ) {
+        FrameRecordHeader header;
+        std::memcpy(&header, records + pos, sizeof(header));
+        if (header.magic != FRAME_RECORD_MAGIC || pos + header.size > written) break;
+        FrameIndexEntry entry;
+        entry.frame = header.frame;
+        entry.stamp = header.stamp;
+        entry.offset = offset + pos;
+        entry.size = header.size;
+        entry.box_count = header.box_count;
+        index.push_back(entry);
+        pos += header.size;
+    }
+    offset += written;
+    fflush(file);
+    return written;
+}
+/*****************************************************
+*功能：在文件末尾写入帧索引表，回填文件头后关闭文件
+*****************************************************/
+void FrameRecordWriter::close() {
+    if (!file) return;
+    FrameFileHeader header;
+    header.magic = FRAME_FILE_MAGIC;
+    header.version = FRAME_FILE_VERSION;
+    header.frame_count = index.size();
+    header.index_offset = offset;
+    header.reserved = 0;
+    size_t table = index.size() * sizeof(FrameIndexEntry);
+    if (fwrite(index.data(), 1, table, file) == table && fseek(file, 0, SEEK_SET) == 0)
+        fwrite(&header, 1, sizeof(header), file);
+    fclose(file);
+    file = nullptr;
+    offset = 0;
+    index.clear();
+}
+
+/*****************************************************
+*功能：返回某个检测框某一类点云的首地址
+*输入：
+*box: 检测框在本帧中的序号
+*which: FrameRecordReader::FRUSTUM/SURFACE/VEHICLE
+*count: 输出该点云的点数
+*输出：x,y,z连续存放的float数组
+*****************************************************/
+const float* FrameView::cloud(const size_t box, const int which, uint32_t& count) const {
+    const float* ptr = points;
+    for (size_t k = 0; k < box; k++)
+        ptr += 3 * (boxes[k].fru_count + boxes[k].sur_count + boxes[k].car_count);
+    const BoxRecord& b = boxes[box];
+    if (which > 0) ptr += 3 * b.fru_count;
+    if (which > 1) ptr += 3 * b.sur_count;
+    count = which == 0 ? b.fru_count : which == 1 ? b.sur_count : b.car_count;
+    return ptr;
+}
+
+/*****************************************************
+*功能：内存映射打开融合结果文件并读取帧索引表
+*输入：
+*path: 文件路径
+*****************************************************/
+bool FrameRecordReader::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FrameFileHeader)) {::close(fd); return false;}
+    void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+    data = static_cast<const char*>(addr);
+    length = st.st_size;
+
+    const FrameFileHeader* header = reinterpret_cast<const FrameFileHeader*>(data);
+    if (header->magic != FRAME_FILE_MAGIC || header->version != FRAME_FILE_VERSION) {close(); return false;}
+    if (header->index_offset == 0 || header->index_offset > length ||
+        header->frame_count > (length - header->index_offset) / sizeof(FrameIndexEntry)) return rebuildIndex();
+    const FrameIndexEntry* table = reinterpret_cast<const FrameIndexEntry*>(data + header->index_offset);
+    index.assign(table, table + header->frame_count);
+    return true;
+}
+/*****************************************************
+*功能：文件未正常关闭时，顺序扫描帧记录重建索引，末尾不完整的记录被忽略
+*****************************************************/
+bool FrameRecordReader::rebuildIndex() {
+    index.clear();
+    for (size_t pos = sizeof(FrameFileHeader); pos + sizeof(FrameRecordHeader) <= length; ) {
+        const FrameRecordHeader* header = reinterpret_cast<const FrameRecordHeader*>(data + pos);
+        if (!checkRecord(pos, header->size)) break;
+        FrameIndexEntry entry;
+        entry.frame = header->frame;
+        entry.stamp = header->stamp;
+        entry.offset = pos;
+        entry.size = header->size;
+        entry.box_count = header->box_count;
+        index.push_back(entry);
+        pos += header->size;
+    }
+    return true;
+}
+/*****************************************************
+*功能：检查一条帧记录是否完整：记录位于文件内，且文件头、检测框段、
+*点云段与索引段的长度之和等于记录长度，各检测框的点数之和等于point_count
+*输入：
+*offset: 记录在文件中的偏移
+*size: 记录的字节数
+*****************************************************/
+bool FrameRecordReader::checkRecord(const uint64_t offset, const uint64_t size) const {
+    if (size < sizeof(FrameRecordHeader) || offset > length || size > length - offset) return false;
+    const FrameRecordHeader* header = reinterpret_cast<const FrameRecordHeader*>(data + offset);
+    if (header->magic != FRAME_RECORD_MAGIC || header->size != size) return false;
+    // 64-bit sums of 32-bit counts can't overflow
+    uint64_t used = sizeof(FrameRecordHeader) + (uint64_t)header->box_count * sizeof(BoxRecord);
+    if (used > size) return false;
+    const BoxRecord* boxes = reinterpret_cast<const BoxRecord*>(data + offset + sizeof(FrameRecordHeader));
+    uint64_t points = 0, indices = 0;
+    for (uint32_t k = 0; k < header->box_count; k++) {
+        points += (uint64_t)boxes[k].fru_count + boxes[k].sur_count + boxes[k].car_count;
+        indices += boxes[k].index_count;
+    }
+    if (points != header->point_count) return false;
+    return used + points * 3 * sizeof(float) + indices * sizeof(int32_t) == size;
+}
+/*****************************************************
+*功能：解除内存映射
+*****************************************************/
+void FrameRecordReader::close() {
+    if (data) munmap(const_cast<char*>(data), length);
+    data = nullptr;
+    length = 0;
+    index.clear();
+}
+/*****************************************************
+*功能：获取第i帧的只读视图，不复制、不解析数据
+*输入：
+*i: 帧在文件中的序号，0 <= i < count()
+*view: 输出的帧视图，在close之前有效
+*输出：记录不完整或与索引不符时返回false
+*****************************************************/
+bool FrameRecordReader::getFrame(const size_t i, FrameView& view) const {
+    if (i >= index.size() || !checkRecord(index[i].offset, index[i].size)) return false;
+    const char* record = data + index[i].offset;
+    view.header = reinterpret_cast<const FrameRecordHeader*>(record);
+    view.boxes = reinterpret_cast<const BoxRecord*>(record + sizeof(FrameRecordHeader));
+    view.points = reinterpret_cast<const float*>(view.boxes + view.header->box_count);
+    view.indices = reinterpret_cast<const int32_t*>(view.points + 3 * view.header->point_count);
+    return true;
+}
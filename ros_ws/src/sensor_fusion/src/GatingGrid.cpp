@@ -0,0 +1,51 @@
+#include "sensor_fusion/GatingGrid.h"
+#include <algorithm>
+#include <cmath>
+
+int64_t GatingGrid::cellOf(const float v) const {
+    return (int64_t)std::floor(v / cell_size);
+}
+void GatingGrid::clear() {
+    cells.clear();
+    visited.clear();
+    query_stamp = 0;
+    entries = 0;
+}
+/*****************************************************
+*功能：登记一个检测框
+*输入：
+*xmin/ymin/xmax/ymax: 检测框的外接矩形
+*index: 检测框的序号，查询时原样返回
+*****************************************************/
+void GatingGrid::insert(const float xmin, const float ymin, const float xmax, const float ymax, const size_t index) {
+    for (int64_t cx = cellOf(xmin); cx <= cellOf(xmax); cx++)
+        for (int64_t cy = cellOf(ymin); cy <= cellOf(ymax); cy++)
+            cells[cellKey(cx, cy)].push_back(index);
+    if (index >= visited.size()) visited.resize(index + 1, 0);
+    entries++;
+}
+/*****************************************************
+*功能：查询与矩形共享网格的检测框，每个检测框只返回一次
+*输入：
+*xmin/ymin/xmax/ymax: 查询矩形
+*candidates: 候选检测框的序号，按登记顺序排列
+*****************************************************/
+void GatingGrid::query(const float xmin, const float ymin, const float xmax, const float ymax, std::vector<size_t>& candidates) {
+    candidates.clear();
+    if (++query_stamp == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        query_stamp = 1;
+    }
+    for (int64_t cx = cellOf(xmin); cx <= cellOf(xmax); cx++)
+        for (int64_t cy = cellOf(ymin); cy <= cellOf(ymax); cy++) {
+            auto it = cells.find(cellKey(cx, cy));
+            if (it == cells.end()) continue;
+            for (size_t index : it->second)
+                if (visited[index] != query_stamp) {
+                    visited[index] = query_stamp;
+                    candidates.push_back(index);
+                }
+        }
+    // keep the greedy assignment independent of the cell layout
+    std::sort(candidates.begin(), candidates.end());
+}
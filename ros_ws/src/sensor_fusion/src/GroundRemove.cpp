@@ -1,174 +1,234 @@
 #include "sensor_fusion/GroundRemove.h"
 /*****************************************************
-*功能：对点云进行预处理
+*功能：对点云进行预处理，直接读取输入视图，只复制一次非地面点
 *输入：
-*移除地面的点云
+*in_view：输入点云的视图（ROS消息缓冲区或PCL点云）
 ******************************************************/
-void GroundRemove::Preprocess()
+template<typename Rig>
+void BasicGroundRemove<Rig>::Preprocess(const PointCloudView &in_view)
 {
-    pcl::PointCloud<pcl::PointXYZI>::Ptr ptrClipAbove(new pcl::PointCloud<pcl::PointXYZI>);
-    pcl::PointCloud<pcl::PointXYZI>::Ptr ptrRemoveClose(new pcl::PointCloud<pcl::PointXYZI>);
-    pcl::PointCloud<pcl::PointXYZI>::Ptr ptrGroundOff(new pcl::PointCloud<pcl::PointXYZI>);
-    // delete points too high and or close
-    ClipAbove(ptrCloud, ptrClipAbove, CLIP_HEIGHT);
-    RemoveClose(ptrClipAbove, ptrRemoveClose, MIN_DISTANCE);
-    // change point formation from XYZI to RTZColor
-    PointCloudXYZIRTColor organizedPoints;
-    std::vector<pcl::PointIndices> radialDivisionIndices;
-    std::vector<pcl::PointIndices> closestIndices;
+    // delete points too high or close, change point formation from XYZI to RTZColor
     std::vector<PointCloudXYZIRTColor> radialOrderedClouds;
-    radial_dividers_num_ = ceil(360 / RADIAL_DIVIDER_ANGLE);
-    XYZI_to_RTZColor(ptrRemoveClose, organizedPoints, radialDivisionIndices, radialOrderedClouds);
+    radial_dividers_num_ = ceil(360 / Rig::radial_divider_angle);
+    XYZI_to_RTZColor(in_view, radialOrderedClouds);
     // delete ground points
     pcl::PointIndices groundIndices;
-    pcl::ExtractIndices<pcl::PointXYZI> ground;
     GroundOff(radialOrderedClouds, groundIndices);
-    
-    ground.setInputCloud(ptrRemoveClose);
-    ground.setIndices(boost::make_shared<pcl::PointIndices>(groundIndices));
-    ground.setNegative(true); //true removes the indices, false leaves only the indices
-    ground.filter(*ptrGroundOff);
-    ptrCloud = ptrGroundOff;
-}
-
-/*****************************************************
-*功能：删除高于指定高度的点云
-*输入：
-*in：输入点云的指针
-*out：输出点云的指针
-*clip_height: 高度阈值
-******************************************************/
-void GroundRemove::ClipAbove(const pcl::PointCloud<pcl::PointXYZI>::Ptr in,
-                             const pcl::PointCloud<pcl::PointXYZI>::Ptr out, double clip_height) {
-    pcl::ExtractIndices<pcl::PointXYZI> cliper;
-    pcl::PointIndices indices;
-
-    for (size_t i = 0; i < in->points.size(); i++)
-        if (in->points[i].z > clip_height)
-            indices.indices.push_back(i);
-    cliper.setInputCloud(in);
-    cliper.setIndices(boost::make_shared<pcl::PointIndices>(indices));
-    cliper.setNegative(true); //ture to remove the indices
-    cliper.filter(*out);
-}
-
-/*****************************************************
-*功能：删除指定距离以内的点云
-*输入：
-*in：输入点云的指针
-*out：输出点云的指针
-*clip_height: 距离阈值
-******************************************************/
-void GroundRemove::RemoveClose(const pcl::PointCloud<pcl::PointXYZI>::Ptr in,
-                                  const pcl::PointCloud<pcl::PointXYZI>::Ptr out, double min_distance) {
-    pcl::ExtractIndices<pcl::PointXYZI> cliper;
-    pcl::PointIndices indices;
 
-    for (size_t i = 0; i < in->points.size(); i++) {
-        double distance = sqrt(in->points[i].x * in->points[i].x + in->points[i].y * in->points[i].y);
-        if (distance < min_distance)
-            indices.indices.push_back(i);
-    }
-    cliper.setInputCloud(in);
-    cliper.setIndices(boost::make_shared<pcl::PointIndices>(indices));
-    cliper.setNegative(true); //ture to remove the indices
-    cliper.filter(*out);
+    // gather the remaining points once, in their original order
+    std::vector<char> removed(in_view.size(), 1);
+    for (const auto &division : radialOrderedClouds)
+        for (const auto &p : division)
+            removed[p.original_index] = 0;
+    for (auto it = groundIndices.indices.begin(); it != groundIndices.indices.end(); it++)
+        removed[*it] = 1;
+    pcl::PointCloud<pcl::PointXYZI>::Ptr ptrGroundOff(new pcl::PointCloud<pcl::PointXYZI>);
+    ptrGroundOff->points.reserve(in_view.size() - groundIndices.indices.size());
+    for (size_t i = 0; i < in_view.size(); i++)
+        if (!removed[i]) ptrGroundOff->points.push_back(in_view.point(i));
+    ptrGroundOff->width = ptrGroundOff->points.size();
+    ptrGroundOff->height = 1;
+    ptrGroundOff->is_dense = true;
+    ptrCloud = ptrGroundOff;
 }
 
 /*****************************************************
-*功能：更改点云数据结构，并按照角度排序
+*功能：删除高于Rig::clip_height及Rig::min_distance以内的点，
+*更改点云数据结构，并按照角度分组（组内按半径排序在GroundOff中按需进行）
 *输入：
-*in_cloud：输入点云的指针
-*out_organized_points：输出点云的指针
-*out_radial_divided_indices: 索引数值
-*out_radial_ordered_clouds: 按角度排序的点云
+*in_view：输入点云的视图
+*out_radial_ordered_clouds: 按角度分组的点云，original_index为视图中的序号
 ******************************************************/
-void GroundRemove::XYZI_to_RTZColor(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud,
-                                    PointCloudXYZIRTColor &out_organized_points,
-                                    std::vector<pcl::PointIndices> &out_radial_divided_indices,
+template<typename Rig>
+void BasicGroundRemove<Rig>::XYZI_to_RTZColor(const PointCloudView &in_view,
                                     std::vector<PointCloudXYZIRTColor> &out_radial_ordered_clouds) {
-    out_organized_points.resize(in_cloud->points.size());
-    out_radial_divided_indices.clear();
-    out_radial_divided_indices.resize(radial_dividers_num_);
     out_radial_ordered_clouds.resize(radial_dividers_num_);
 
-    for (size_t i = 0; i < in_cloud->points.size(); i++) {
-        PointXYZIRTColor new_point;
-        auto radius = (float)sqrt(
-            in_cloud->points[i].x * in_cloud->points[i].x + in_cloud->points[i].y * in_cloud->points[i].y);
-        auto theta = (float)atan2(in_cloud->points[i].y, in_cloud->points[i].x) * 180 / M_PI;
+    for (size_t i = 0; i < in_view.size(); i++) {
+        float x = in_view.x(i);
+        float y = in_view.y(i);
+        float z = in_view.z(i);
+        if (z > Rig::clip_height) continue;
+        auto radius = (float)sqrt(x * x + y * y);
+        if (radius < Rig::min_distance) continue;
+        auto theta = (float)atan2(y, x) * 180 / M_PI;
         if (theta < 0)
             theta += 360;
         //differential of angle and radial
-        auto radial_div = (size_t)floor(theta / RADIAL_DIVIDER_ANGLE);
-        auto concentric_div = (size_t)floor(fabs(radius / concentric_divider_distance_));
+        auto radial_div = std::min((size_t)floor(theta / Rig::radial_divider_angle), radial_dividers_num_ - 1);
+        auto concentric_div = (size_t)floor(fabs(radius / Rig::concentric_divider_distance));
 
-        new_point.point = in_cloud->points[i];
+        PointXYZIRTColor new_point;
+        new_point.point.x = x;
+        new_point.point.y = y;
+        new_point.point.z = z;
+        new_point.point.intensity = in_view.intensity(i);
         new_point.radius = radius;
         new_point.theta = theta;
         new_point.radial_div = radial_div;
         new_point.concentric_div = concentric_div;
         new_point.original_index = i;
 
-        out_organized_points[i] = new_point;
-        out_radial_divided_indices[radial_div].indices.push_back(i);
         out_radial_ordered_clouds[radial_div].push_back(new_point);
     }
-
-    for (size_t i = 0; i < radial_dividers_num_; i++)
-        std::sort(out_radial_ordered_clouds[i].begin(), out_radial_ordered_clouds[i].end(),
-                  [](const PointXYZIRTColor &a, const PointXYZIRTColor &b) { return a.radius < b.radius; });
 }
 
 /*****************************************************
-*功能：判断点云是否为地面点云
+*功能：判断点云是否为地面点云。若存在上一帧的地面模型，
+*先对每个扇区做残差检验，仅对残差超限的扇区重新分割
 *输入：
-*in_radial_ordered_clouds: 按角度排序的点云
+*in_radial_ordered_clouds: 按角度分组的点云
 *out_ground_indices: 地面点云的索引序号
 ******************************************************/
-void GroundRemove::GroundOff(std::vector<PointCloudXYZIRTColor> &in_radial_ordered_clouds, pcl::PointIndices &out_ground_indices) {
+template<typename Rig>
+void BasicGroundRemove<Rig>::GroundOff(std::vector<PointCloudXYZIRTColor> &in_radial_ordered_clouds, pcl::PointIndices &out_ground_indices) {
     out_ground_indices.indices.clear();
+    size_t sector_num = (in_radial_ordered_clouds.size() + GROUND_SECTOR_DIVS - 1) / GROUND_SECTOR_DIVS;
+    if (ptrModel) {
+        if (ptrModel->sectors.size() != sector_num) {
+            ptrModel->sectors.clear();
+            ptrModel->sectors.resize(sector_num);
+        }
+        ptrModel->cached_sectors = 0;
+        ptrModel->segmented_sectors = 0;
+    }
 
-    for (size_t i = 0; i < in_radial_ordered_clouds.size(); i++) {//sweep through each radial division 
-        float prev_radius = 0.f;
-        float prev_height = -SENSOR_HEIGHT;
-        bool prev_ground = false;
-        bool current_ground = false;
-        for (size_t j = 0; j < in_radial_ordered_clouds[i].size(); j++) {//loop through each point in the radial div
-            float points_distance = in_radial_ordered_clouds[i][j].radius - prev_radius;
-            float height_threshold = tan(DEG2RAD(local_max_slope_)) * points_distance;
-            float current_height = in_radial_ordered_clouds[i][j].point.z;
-            float general_height_threshold = tan(DEG2RAD(general_max_slope_)) * in_radial_ordered_clouds[i][j].radius;
-            //for points which are very close causing the height threshold to be tiny, set a minimum value
-            if (points_distance > concentric_divider_distance_ && height_threshold < min_height_threshold_)
-                height_threshold = min_height_threshold_;
-            //check current point height against the LOCAL threshold (previous point)
-            if (current_height <= (prev_height + height_threshold) && current_height >= (prev_height - height_threshold))
-                //Check again using general geometry (radius from origin) if previous points wasn't ground
-                if (!prev_ground)
-                    if (current_height <= (-SENSOR_HEIGHT + general_height_threshold) && current_height >= (-SENSOR_HEIGHT - general_height_threshold))
-                        current_ground = true;
-                    else
-                        current_ground = false;
-                else
-                    current_ground = true;
-            else if (points_distance > reclass_distance_threshold_ && (current_height <= (-SENSOR_HEIGHT + height_threshold) && current_height >= (-SENSOR_HEIGHT - height_threshold)))
-            //check if previous point is too far from previous one, if so classify again
-                current_ground = true;
-            else
-                    current_ground = false;
+    for (size_t s = 0; s < sector_num; s++) {
+        size_t div_begin = s * GROUND_SECTOR_DIVS;
+        size_t div_end = std::min(div_begin + GROUND_SECTOR_DIVS, in_radial_ordered_clouds.size());
+        // least squares sums of the ground line z = height + slope*r: n, r, z, r*r, r*z
+        double fit[5] = {0, 0, 0, 0, 0};
+        bool cached = false;
+        if (ptrModel) {
+            GroundModel::Sector &sector = ptrModel->sectors[s];
+            // refresh is staggered over sectors so that the per-frame cost stays flat
+            bool refresh = (ptrModel->frame + s) % GROUND_MODEL_REFRESH == 0;
+            if (sector.valid && !refresh)
+                cached = CachedSector(sector, in_radial_ordered_clouds, div_begin, div_end, out_ground_indices, fit);
+        }
+        if (!cached)
+            for (size_t i = div_begin; i < div_end; i++)
+                SegmentDivision(in_radial_ordered_clouds[i], out_ground_indices, fit);
+        if (!ptrModel) continue;
+
+        // renew the sector model with the ground points of this frame
+        GroundModel::Sector &sector = ptrModel->sectors[s];
+        size_t point_num = 0;
+        for (size_t i = div_begin; i < div_end; i++) point_num += in_radial_ordered_clouds[i].size();
+        sector.ground_ratio = point_num ? fit[0] / point_num : 0;
+        if (fit[0] >= GROUND_MODEL_MIN_POINTS) {
+            double det = fit[0] * fit[3] - fit[1] * fit[1];
+            sector.slope = std::abs(det) > 1e-6 ? (fit[0] * fit[4] - fit[1] * fit[2]) / det : 0;
+            sector.height = (fit[2] - sector.slope * fit[1]) / fit[0];
+            sector.valid = true;
+        } else sector.valid = false;
+        if (cached) ptrModel->cached_sectors++;
+        else ptrModel->segmented_sectors++;
+    }
+    if (ptrModel) ptrModel->frame++;
+}
 
-            if (current_ground) {
-                out_ground_indices.indices.push_back(in_radial_ordered_clouds[i][j].original_index);
-                prev_ground = true;
+/*****************************************************
+*功能：使用缓存的扇区地面模型进行残差检验与分类
+*输入：
+*sector: 上一帧的扇区地面模型
+*in_radial_ordered_clouds: 按角度分组的点云
+*div_begin/div_end: 扇区包含的角度分组范围
+*out_ground_indices: 地面点云的索引序号
+*fit: 地面点的最小二乘累加量
+*输出：
+*true: 扇区由模型分类完成；false: 残差超限，需要重新分割
+******************************************************/
+template<typename Rig>
+bool BasicGroundRemove<Rig>::CachedSector(const GroundModel::Sector &sector, const std::vector<PointCloudXYZIRTColor> &in_radial_ordered_clouds,
+                                size_t div_begin, size_t div_end, pcl::PointIndices &out_ground_indices, double (&fit)[5]) {
+    size_t point_num = 0;
+    size_t below_num = 0;
+    size_t band_num = 0;
+    size_t near_num = 0;
+    size_t risen_num = 0;
+    float band_sum = 0;
+    for (size_t i = div_begin; i < div_end; i++)
+        for (const auto &p : in_radial_ordered_clouds[i]) {
+            float residual = p.point.z - (sector.height + sector.slope * p.radius);
+            point_num++;
+            if (residual < -GROUND_RESIDUAL_TOL) below_num++;
+            else if (residual <= GROUND_RESIDUAL_TOL) {band_num++; band_sum += residual;}
+            if (p.radius < GROUND_NEAR_RADIUS) {
+                near_num++;
+                if (residual > GROUND_RESIDUAL_TOL && residual <= GROUND_RISE_TOL) risen_num++;
             }
-            else
-                prev_ground = false;
-            prev_radius = in_radial_ordered_clouds[i][j].radius;
-            prev_height = in_radial_ordered_clouds[i][j].point.z;
         }
-    }
+    // points below the ground line or a drifting band mean the ground changed
+    if (below_num > GROUND_OUTLIER_RATIO * point_num) return false;
+    if (band_num && std::abs(band_sum / band_num) > GROUND_RESIDUAL_TOL / 2) return false;
+    // ground rising above the band leaves it: the band empties and points gather just above it near the sensor
+    if (band_num < GROUND_BAND_DROP * sector.ground_ratio * point_num) return false;
+    if (risen_num > GROUND_OUTLIER_RATIO * near_num) return false;
+
+    for (size_t i = div_begin; i < div_end; i++)
+        for (const auto &p : in_radial_ordered_clouds[i]) {
+            float residual = p.point.z - (sector.height + sector.slope * p.radius);
+            if (std::abs(residual) <= GROUND_RESIDUAL_TOL) {
+                out_ground_indices.indices.push_back(p.original_index);
+                fit[0] += 1; fit[1] += p.radius; fit[2] += p.point.z;
+                fit[3] += p.radius * p.radius; fit[4] += p.radius * p.point.z;
+            }
+        }
+    return true;
 }
 
+/*****************************************************
+*功能：对单个角度分组按半径排序后逐点判断是否为地面点云
+*输入：
+*in_radial_cloud: 单个角度分组的点云
+*out_ground_indices: 地面点云的索引序号
+*fit: 地面点的最小二乘累加量
+******************************************************/
+template<typename Rig>
+void BasicGroundRemove<Rig>::SegmentDivision(PointCloudXYZIRTColor &in_radial_cloud, pcl::PointIndices &out_ground_indices, double (&fit)[5]) {
+    std::sort(in_radial_cloud.begin(), in_radial_cloud.end(),
+              [](const PointXYZIRTColor &a, const PointXYZIRTColor &b) { return a.radius < b.radius; });
+    float prev_radius = 0.f;
+    float prev_height = -Rig::sensor_height;
+    bool prev_ground = false;
+    bool current_ground = false;
+    for (size_t j = 0; j < in_radial_cloud.size(); j++) {//loop through each point in the radial div
+        float points_distance = in_radial_cloud[j].radius - prev_radius;
+        float height_threshold = tan(DEG2RAD(Rig::local_max_slope)) * points_distance;
+        float current_height = in_radial_cloud[j].point.z;
+        float general_height_threshold = tan(DEG2RAD(Rig::general_max_slope)) * in_radial_cloud[j].radius;
+        //for points which are very close causing the height threshold to be tiny, set a minimum value
+        if (points_distance > Rig::concentric_divider_distance && height_threshold < Rig::min_height_threshold)
+            height_threshold = Rig::min_height_threshold;
+        //check current point height against the LOCAL threshold (previous point)
+        if (current_height <= (prev_height + height_threshold) && current_height >= (prev_height - height_threshold))
+            //Check again using general geometry (radius from origin) if previous points wasn't ground
+            if (!prev_ground)
+                if (current_height <= (-Rig::sensor_height + general_height_threshold) && current_height >= (-Rig::sensor_height - general_height_threshold))
+                    current_ground = true;
+                else
+                    current_ground = false;
+            else
+                current_ground = true;
+        else if (points_distance > Rig::reclass_distance_threshold && (current_height <= (-Rig::sensor_height + height_threshold) && current_height >= (-Rig::sensor_height - height_threshold)))
+        //check if previous point is too far from previous one, if so classify again
+            current_ground = true;
+        else
+                current_ground = false;
 
+        if (current_ground) {
+            out_ground_indices.indices.push_back(in_radial_cloud[j].original_index);
+            fit[0] += 1; fit[1] += in_radial_cloud[j].radius; fit[2] += current_height;
+            fit[3] += in_radial_cloud[j].radius * in_radial_cloud[j].radius;
+            fit[4] += in_radial_cloud[j].radius * current_height;
+            prev_ground = true;
+        }
+        else
+            prev_ground = false;
+        prev_radius = in_radial_cloud[j].radius;
+        prev_height = in_radial_cloud[j].point.z;
+    }
+}
 
+template class BasicGroundRemove<KittiRig>;
@@ -0,0 +1,113 @@
+#include "sensor_fusion/Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+/*****************************************************
+*功能：计算数值所在的桶。小于HIST_SUB_BUCKETS的值各占一个桶，
+*之后每个2的幂区间均分为HIST_SUB_BUCKETS个桶
+*****************************************************/
+size_t Histogram::bucketOf(const uint64_t value) {
+    if (value < HIST_SUB_BUCKETS) return value;
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - HIST_SUB_BITS;
+    size_t sub = (value >> shift) & (HIST_SUB_BUCKETS - 1);
+    return (shift + 1) * HIST_SUB_BUCKETS + sub;
+}
+/*****************************************************
+*功能：桶内数值的上界，用于报告分位数
+*****************************************************/
+uint64_t Histogram::bucketUpper(const size_t bucket) {
+    if (bucket < HIST_SUB_BUCKETS) return bucket;
+    int shift = bucket / HIST_SUB_BUCKETS - 1;
+    uint64_t sub = bucket % HIST_SUB_BUCKETS;
+    return ((HIST_SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+void Histogram::record(const uint64_t value) {
+    buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t prev = max_value.load(std::memory_order_relaxed);
+    while (value > prev && !max_value.compare_exchange_weak(prev, value, std::memory_order_relaxed));
+}
+void Histogram::reset() {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max_value.store(0, std::memory_order_relaxed);
+}
+double Histogram::mean() const {
+    uint64_t n = count();
+    return n ? (double)sum.load(std::memory_order_relaxed) / n : 0.0;
+}
+/*****************************************************
+*功能：估计分位数，返回所在桶的上界（不超过最大值）
+*输入：
+*p: 分位，0~1
+*****************************************************/
+uint64_t Histogram::percentile(const double p) const {
+    uint64_t n = count();
+    if (!n) return 0;
+    uint64_t rank = (uint64_t)(p * n + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < HIST_BUCKETS; b++) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucketUpper(b), max());
+    }
+    return max();
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+const char* Profiler::stageName(const int stage) {
+    static const char* names[PROF_STAGE_COUNT] = {"from_ros_msg", "ground_remove", "project_cloud",
+        "occlusion_table", "clip_frustum", "eu_cluster", "lfit", "hungaria", "result_log", "drawing", "frame"};
+    return names[stage];
+}
+const char* Profiler::counterName(const int counter) {
+    static const char* names[CNT_COUNTER_COUNT] = {"points_in", "points_ground_free", "boxes", "clusters"};
+    return names[counter];
+}
+void Profiler::reset() {
+    for (auto& h : stages) h.reset();
+    for (auto& h : counters) h.reset();
+}
+/*****************************************************
+*功能：汇总各阶段与计数的统计量，跳过没有记录的项
+*****************************************************/
+std::vector<ProfileStats> Profiler::snapshot() const {
+    std::vector<ProfileStats> stats;
+    auto add = [&stats](const Histogram& h, const char* name, const char* unit) {
+        if (!h.count()) return;
+        ProfileStats s;
+        s.name = name;
+        s.unit = unit;
+        s.count = h.count();
+        s.mean = h.mean();
+        s.p50 = h.percentile(0.5);
+        s.p99 = h.percentile(0.99);
+        s.max = h.max();
+        stats.push_back(s);
+    };
+    for (int i = 0; i < PROF_STAGE_COUNT; i++) add(stages[i], stageName(i), "ns");
+    for (int i = 0; i < CNT_COUNTER_COUNT; i++) add(counters[i], counterName(i), "count");
+    return stats;
+}
+/*****************************************************
+*功能：将统计量写入CSV文件
+*输入：
+*path: 文件路径，已存在时被覆盖
+*****************************************************/
+bool Profiler::writeCsv(const std::string& path) const {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    fprintf(file, "name,unit,count,mean,p50,p99,max\n");
+    for (const auto& s : snapshot())
+        fprintf(file, "%s,%s,%llu,%.1f,%llu,%llu,%llu\n", s.name.c_str(), s.unit.c_str(),
+                (unsigned long long)s.count, s.mean, (unsigned long long)s.p50,
+                (unsigned long long)s.p99, (unsigned long long)s.max);
+    fclose(file);
+    return true;
+}
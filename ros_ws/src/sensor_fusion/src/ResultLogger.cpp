@@ -0,0 +1,97 @@
+#include "sensor_fusion/ResultLogger.h"
+#include <cerrno>
+#include <ctime>
+#include <iostream>
+#include <sys/stat.h>
+
+/*****************************************************
+*功能：逐级创建目录
+*****************************************************/
+static bool make_directory(const std::string& path) {
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+        std::string sub = path.substr(0, pos);
+        if (!sub.empty() && mkdir(sub.c_str(), 0755) != 0 && errno != EEXIST) return false;
+        if (pos == std::string::npos) return true;
+    }
+}
+/*****************************************************
+*功能：初始化并启动后台写线程
+*输入：
+*directory_: 记录文件所在目录，不存在时自动创建
+*max_file_size_: 单个文件的最大字节数，超过后写入新文件
+*****************************************************/
+ResultLogger::ResultLogger(const std::string& directory_, const size_t max_file_size_)
+    : directory(directory_), max_file_size(max_file_size_), enabled(true), stop(false), dropped_frames(0),
+      file_index(0) {
+    time_t now = time(0);
+    tm *ltm = localtime(&now);
+    char name[64];
+    strftime(name, sizeof(name), "fusion_%Y_%m_%d_%H%M%S", ltm);
+    prefix = name;
+    if (!make_directory(directory)) std::cerr << "Cannot create log directory: " << directory << std::endl;
+    writer = std::thread(&ResultLogger::writerLoop, this);
+}
+/*****************************************************
+*功能：写完剩余数据后关闭文件
+*****************************************************/
+ResultLogger::~ResultLogger() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_one();
+    if (writer.joinable()) writer.join();
+    file.close();
+}
+/*****************************************************
+*功能：返回因积压被丢弃的帧数
+*****************************************************/
+size_t ResultLogger::droppedFrames() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return dropped_frames;
+}
+/*****************************************************
+*功能：记录一帧融合结果，仅序列化到前台缓冲区，不等待磁盘
+*输入：
+*frame: 帧序号
+*stamp: 点云时间戳，纳秒
+*detections: 单帧检测结果
+*****************************************************/
+void ResultLogger::logFrame(const uint64_t frame, const int64_t stamp, LinkList<detection_cam>& detections) {
+    if (!enabled) return;
+    std::vector<char> record;
+    append_frame_record(record, frame, stamp, detections);
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (front.size() + record.size() > RESULT_LOG_MAX_BUFFER) {dropped_frames++; return;}
+        front.insert(front.end(), record.begin(), record.end());
+    }
+    cv.notify_one();
+}
+/*****************************************************
+*功能：后台写线程，交换双缓冲后将后台缓冲区写入文件
+*****************************************************/
+void ResultLogger::writerLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this] {return stop || !front.empty();});
+            if (front.empty() && stop) break;
+            front.swap(back);
+        }
+        if ((!file.isOpen() || file.bytes() >= max_file_size) && !openNextFile()) {back.clear(); continue;}
+        file.append(back.data(), back.size());
+        back.clear();
+    }
+}
+/*****************************************************
+*功能：关闭当前文件（写入帧索引）并打开下一个滚动文件
+*****************************************************/
+bool ResultLogger::openNextFile() {
+    file.close();
+    char index[16];
+    snprintf(index, sizeof(index), "_%03zu.frec", file_index++);
+    std::string path = directory + "/" + prefix + index;
+    if (!file.open(path)) std::cerr << "Cannot open log file: " << path << std::endl;
+    return file.isOpen();
+}
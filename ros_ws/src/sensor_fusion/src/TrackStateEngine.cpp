@@ -0,0 +1,206 @@
+#include "sensor_fusion/TrackStateEngine.h"
+/*****************************************************
+*功能：为新物体分配槽位，第一次观测前状态未初始化
+*输入：
+*ID: 物体的trackID
+*输出：
+*false: 该ID已存在
+*****************************************************/
+bool TrackStateEngine::add(const int ID) {
+    if (contains(ID)) return false;
+    slots[ID] = ids.size();
+    ids.push_back(ID);
+    for (auto& s : state) s.push_back(0);
+    for (auto& c : cov) c.push_back(0);
+    meas_x.push_back(0);
+    meas_y.push_back(0);
+    meas_mask.push_back(0);
+    initialized.push_back(0);
+    return true;
+}
+/*****************************************************
+*功能：删除物体，最后一个槽位移入被删除的位置
+*输入：
+*ID: 物体的trackID
+*输出：
+*false: 该ID不存在
+*****************************************************/
+bool TrackStateEngine::remove(const int ID) {
+    auto it = slots.find(ID);
+    if (it == slots.end()) return false;
+    size_t slot = it->second;
+    size_t last = ids.size() - 1;
+    if (slot != last) {
+        for (auto& s : state) s[slot] = s[last];
+        for (auto& c : cov) c[slot] = c[last];
+        meas_x[slot] = meas_x[last];
+        meas_y[slot] = meas_y[last];
+        meas_mask[slot] = meas_mask[last];
+        initialized[slot] = initialized[last];
+        ids[slot] = ids[last];
+        slots[ids[slot]] = slot;
+    }
+    for (auto& s : state) s.pop_back();
+    for (auto& c : cov) c.pop_back();
+    meas_x.pop_back();
+    meas_y.pop_back();
+    meas_mask.pop_back();
+    initialized.pop_back();
+    ids.pop_back();
+    slots.erase(it);
+    return true;
+}
+void TrackStateEngine::clear() {
+    for (auto& s : state) s.clear();
+    for (auto& c : cov) c.clear();
+    meas_x.clear();
+    meas_y.clear();
+    meas_mask.clear();
+    initialized.clear();
+    ids.clear();
+    slots.clear();
+}
+/*****************************************************
+*功能：以第一次观测初始化槽位，速度未知
+*****************************************************/
+void TrackStateEngine::initSlot(const size_t slot, const float px, const float py) {
+    state[SX][slot] = px;
+    state[SY][slot] = py;
+    state[SVX][slot] = state[SVY][slot] = 0;
+    for (auto& c : cov) c[slot] = 0;
+    cov[P00][slot] = cov[P11][slot] = KF_POSITION_NOISE * KF_POSITION_NOISE;
+    cov[P22][slot] = cov[P33][slot] = KF_INITIAL_VELOCITY_STD * KF_INITIAL_VELOCITY_STD;
+    meas_mask[slot] = 0;
+    initialized[slot] = 1;
+}
+/*****************************************************
+*功能：按匀速模型一次预测所有物体dt秒后的状态，过程噪声为白噪声加速度。
+*P = F*P*F' + Q，F = [I dt*I; 0 I]，展开为上三角元素的标量运算；
+*未初始化的槽位一并计算，初始化时会被覆盖
+*输入：
+*dt: 距上一次预测的时间，秒
+*****************************************************/
+void TrackStateEngine::predict(const float dt) {
+    const size_t n = ids.size();
+    const float q = KF_ACCEL_NOISE * KF_ACCEL_NOISE;
+    const float q_pos = q * dt * dt * dt * dt / 4;
+    const float q_cross = q * dt * dt * dt / 2;
+    const float q_vel = q * dt * dt;
+    float* x = state[SX].data();
+    float* y = state[SY].data();
+    const float* vx = state[SVX].data();
+    const float* vy = state[SVY].data();
+    float* p00 = cov[P00].data(); float* p01 = cov[P01].data(); float* p02 = cov[P02].data(); float* p03 = cov[P03].data();
+    float* p11 = cov[P11].data(); float* p12 = cov[P12].data(); float* p13 = cov[P13].data();
+    float* p22 = cov[P22].data(); const float* p23 = cov[P23].data(); float* p33 = cov[P33].data();
+    // the arrays never overlap
+#pragma GCC ivdep
+    for (size_t i = 0; i < n; i++) {
+        x[i] += dt * vx[i];
+        y[i] += dt * vy[i];
+        p00[i] += dt * (2 * p02[i] + dt * p22[i]) + q_pos;
+        p01[i] += dt * (p03[i] + p12[i] + dt * p23[i]);
+        p02[i] += dt * p22[i] + q_cross;
+        p03[i] += dt * p23[i];
+        p11[i] += dt * (2 * p13[i] + dt * p33[i]) + q_pos;
+        p12[i] += dt * p23[i];
+        p13[i] += dt * p33[i] + q_cross;
+        p22[i] += q_vel;
+        p33[i] += q_vel;
+    }
+}
+/*****************************************************
+*功能：登记物体本帧的观测，在update中统一更新；未初始化的物体直接以观测初始化
+*输入：
+*ID: 物体的trackID
+*px/py: 检测框中心位置
+*****************************************************/
+void TrackStateEngine::setMeasurement(const int ID, const float px, const float py) {
+    auto it = slots.find(ID);
+    if (it == slots.end()) return;
+    size_t slot = it->second;
+    if (!initialized[slot]) {initSlot(slot, px, py); return;}
+    meas_x[slot] = px;
+    meas_y[slot] = py;
+    meas_mask[slot] = 1;
+}
+/*****************************************************
+*功能：一次遍历以登记的观测更新所有物体，没有观测的槽位增益乘以0保持不变。
+*S = P[0:2,0:2] + R，K = P[:,0:2]*inv(S)，x += K*y，P -= K*P[0:2,:]
+*****************************************************/
+void TrackStateEngine::update() {
+    const size_t n = ids.size();
+    const float r = KF_POSITION_NOISE * KF_POSITION_NOISE;
+    float* x = state[SX].data(); float* y = state[SY].data();
+    float* vx = state[SVX].data(); float* vy = state[SVY].data();
+    float* p00 = cov[P00].data(); float* p01 = cov[P01].data(); float* p02 = cov[P02].data(); float* p03 = cov[P03].data();
+    float* p11 = cov[P11].data(); float* p12 = cov[P12].data(); float* p13 = cov[P13].data();
+    float* p22 = cov[P22].data(); float* p23 = cov[P23].data(); float* p33 = cov[P33].data();
+    const float* mx = meas_x.data();
+    const float* my = meas_y.data();
+    float* mask = meas_mask.data();
+#pragma GCC ivdep
+    for (size_t i = 0; i < n; i++) {
+        const float s00 = p00[i] + r, s01 = p01[i], s11 = p11[i] + r;
+        const float inv_det = mask[i] / (s00 * s11 - s01 * s01);
+        // rows of K, zero when the slot has no measurement
+        const float k00 = (p00[i] * s11 - p01[i] * s01) * inv_det, k01 = (p01[i] * s00 - p00[i] * s01) * inv_det;
+        const float k10 = (p01[i] * s11 - p11[i] * s01) * inv_det, k11 = (p11[i] * s00 - p01[i] * s01) * inv_det;
+        const float k20 = (p02[i] * s11 - p12[i] * s01) * inv_det, k21 = (p12[i] * s00 - p02[i] * s01) * inv_det;
+        const float k30 = (p03[i] * s11 - p13[i] * s01) * inv_det, k31 = (p13[i] * s00 - p03[i] * s01) * inv_det;
+        const float e0 = mx[i] - x[i], e1 = my[i] - y[i];
+        x[i] += k00 * e0 + k01 * e1;
+        y[i] += k10 * e0 + k11 * e1;
+        vx[i] += k20 * e0 + k21 * e1;
+        vy[i] += k30 * e0 + k31 * e1;
+        // rows 0 and 1 of P before the update
+        const float a0 = p00[i], a1 = p01[i], a2 = p02[i], a3 = p03[i];
+        const float b1 = p11[i], b2 = p12[i], b3 = p13[i];
+        p00[i] -= k00 * a0 + k01 * a1;
+        p01[i] -= k00 * a1 + k01 * b1;
+        p02[i] -= k00 * a2 + k01 * b2;
+        p03[i] -= k00 * a3 + k01 * b3;
+        p11[i] -= k10 * a1 + k11 * b1;
+        p12[i] -= k10 * a2 + k11 * b2;
+        p13[i] -= k10 * a3 + k11 * b3;
+        p22[i] -= k20 * a2 + k21 * b2;
+        p23[i] -= k20 * a3 + k21 * b3;
+        p33[i] -= k30 * a3 + k31 * b3;
+        mask[i] = 0;
+    }
+}
+bool TrackStateEngine::isInitialized(const int ID) const {
+    auto it = slots.find(ID);
+    return it != slots.end() && initialized[it->second];
+}
+/*****************************************************
+*功能：观测与预测状态之间的马氏距离平方，用于关联前的门限检验
+*输入：
+*ID: 物体的trackID
+*px/py: 检测框中心位置
+*输出：
+*马氏距离平方，物体不存在或未初始化时为0
+*****************************************************/
+float TrackStateEngine::gateDistance(const int ID, const float px, const float py) const {
+    auto it = slots.find(ID);
+    if (it == slots.end() || !initialized[it->second]) return 0;
+    size_t slot = it->second;
+    const float r = KF_POSITION_NOISE * KF_POSITION_NOISE;
+    const float s00 = cov[P00][slot] + r, s01 = cov[P01][slot], s11 = cov[P11][slot] + r;
+    const float e0 = px - state[SX][slot], e1 = py - state[SY][slot];
+    return (s11 * e0 * e0 - 2 * s01 * e0 * e1 + s00 * e1 * e1) / (s00 * s11 - s01 * s01);
+}
+bool TrackStateEngine::getPosition(const int ID, float &px, float &py) const {
+    auto it = slots.find(ID);
+    if (it == slots.end() || !initialized[it->second]) return false;
+    px = state[SX][it->second];
+    py = state[SY][it->second];
+    return true;
+}
+bool TrackStateEngine::getVelocity(const int ID, float &vx, float &vy) const {
+    auto it = slots.find(ID);
+    if (it == slots.end() || !initialized[it->second]) return false;
+    vx = state[SVX][it->second];
+    vy = state[SVY][it->second];
+    return true;
+}
@@ -1,4 +1,5 @@
 #include "sensor_fusion/Tracking.h"
+#include "sensor_fusion/GatingGrid.h"
 
 //static int trackNum = 0;
 static int nextID = 1;
@@ -24,17 +25,62 @@ int Object::getTrackID() {
     return trackID;
 }
 
-bool Object::renewDimenstion() {
-    detection_cam tmp = getItem(items-1);
-    tracking_length = tracking_length < tmp.box3d.length ? tmp.box3d.length : tracking_length;
-    tracking_width = tracking_width < tmp.box3d.width ? tmp.box3d.width : tracking_width;
-    tracking_height = tracking_height < tmp.box3d.height ? tmp.box3d.height : tracking_height;
+/*****************************************************
+*功能：添加一帧检测到轨迹中并更新尺寸统计，历史中的检测不含点云
+*输入：
+*det：匹配好的检测结果
+******************************************************/
+bool Object::addDetection(const detection_cam& det) {
+    detection_cam entry;
+    entry.id = det.id;
+    entry.miss = det.miss;
+    entry.duplicate = det.duplicate;
+    entry.far = det.far;
+    entry.distance_far = det.distance_far;
+    entry.box = det.box;
+    entry.box3d = det.box3d;
+    entry.corner_x = det.corner_x;
+    entry.corner_y = det.corner_y;
+    if (isFull()) delItem(0);
+    renewDimenstion(det.box3d);
+    return addItem(entry);
+}
+/*****************************************************
+*功能：以新的三维检测框更新尺寸的最大值与指数平滑值，没有点云拟合结果时跳过
+*输入：
+*box3d：新的三维检测框
+******************************************************/
+bool Object::renewDimenstion(const Box3d& box3d) {
+    if (!has_position(box3d)) return false;
+    tracking_length = tracking_length < box3d.length ? box3d.length : tracking_length;
+    tracking_width = tracking_width < box3d.width ? box3d.width : tracking_width;
+    tracking_height = tracking_height < box3d.height ? box3d.height : tracking_height;
+    float alpha = dimension_samples ? DIMENSION_EMA_ALPHA : 1;
+    smoothed_length += alpha * (box3d.length - smoothed_length);
+    smoothed_width += alpha * (box3d.width - smoothed_width);
+    smoothed_height += alpha * (box3d.height - smoothed_height);
+    dimension_samples++;
+    return true;
 }
-void Object::getDimension(float &length_, float &width_, float &height_){
+/*****************************************************
+*功能：返回轨迹中尺寸的最大值
+*****************************************************/
+void Object::getDimension(float &length_, float &width_, float &height_) const {
     length_ = tracking_length;
     width_ = tracking_width;
     height_ = tracking_height;
 }
+/*****************************************************
+*功能：返回尺寸的指数平滑值
+*输出：
+*false: 还没有点云拟合得到的三维检测框
+*****************************************************/
+bool Object::getSmoothedDimension(float &length_, float &width_, float &height_) const {
+    length_ = smoothed_length;
+    width_ = smoothed_width;
+    height_ = smoothed_height;
+    return dimension_samples != 0;
+}
 /*=================================================================================
 Class ObjectList
 =================================================================================*/
@@ -46,8 +92,16 @@ Class ObjectList
 ******************************************************/
 bool ObjectList::delID(const int ID) {
     int itemNum = searchID(ID);
+    engine.remove(ID);
     return delItem(itemNum);
 }
+/*****************************************************
+*功能：删除所有物体及其运动状态
+******************************************************/
+void ObjectList::clear() {
+    Reset();
+    engine.clear();
+}
 
 /*****************************************************
 *功能：定位指定trackID的Object的顺序位置
@@ -82,17 +136,30 @@ int ObjectList::searchID(const int ID) {
 *ID：寻找指定trackID的Object
 *track：匹配好的检测结果
 ******************************************************/
-bool ObjectList::addTrack(const int ID, const detection_cam track) {
+bool ObjectList::addTrack(const int ID, const detection_cam& track) {
     int itemNum = searchID(ID);
     Object* ptrObject = &getItem(itemNum);
     if (ptrObject->getTrackID() == ID) {
-        ptrObject->addItem(track);
-        ptrObject->renewDimenstion();
+        ptrObject->addDetection(track);
+        if (has_position(track.box3d)) engine.setMeasurement(ID, track.box3d.pos.x, track.box3d.pos.y);
         return true;
     } else
         return false;
 }
 /*****************************************************
+*功能：以检测结果创建新物体及其运动状态
+*输入：
+*ID：新物体的trackID
+*track：物体的第一个检测结果
+******************************************************/
+bool ObjectList::newTrack(const int ID, const detection_cam& track) {
+    Object newObject(ID, track);
+    if (!addItem(newObject)) return false;
+    engine.add(ID);
+    if (has_position(track.box3d)) engine.setMeasurement(ID, track.box3d.pos.x, track.box3d.pos.y);
+    return true;
+}
+/*****************************************************
 *功能：返回指定trackID的Object指针
 *输入：
 *ID：寻找指定trackID的Object
@@ -104,131 +171,140 @@ Object* ObjectList::getObject(const int ID) {
     return ptrObject;
 }
 /*****************************************************
-*功能：两帧检测结果的匹配，创建新物体，更新物体的轨迹
+*功能：预测所有物体在dt秒后的位置
+*****************************************************/
+void ObjectList::predict(const float dt) {
+    engine.predict(dt);
+}
+/*****************************************************
+*功能：以本帧匹配的检测结果更新所有物体的运动状态
+*****************************************************/
+void ObjectList::update() {
+    engine.update();
+}
+/*****************************************************
+*功能：三维检测框是否落在物体预测位置的门限内，
+*物体或检测框没有位置信息时不做限制
+*****************************************************/
+bool ObjectList::inGate(const int ID, const Box3d& box3d) const {
+    if (!has_position(box3d)) return true;
+    return engine.gateDistance(ID, box3d.pos.x, box3d.pos.y) <= KF_GATE_CHI2;
+}
+/*****************************************************
+*功能：检测框在关联网格中的范围。图像IoU使用二维检测框；鸟瞰图度量使用三维检测框的外接矩形，
+*中心距离再向外扩展MAX_CENTER_DISTANCE；没有三维检测框时返回false，不参与鸟瞰图关联
+*****************************************************/
+static bool association_extent(const detection_cam& det, const AssociationMetric metric,
+                               float &xmin, float &ymin, float &xmax, float &ymax) {
+    if (metric == ASSOC_IOU_2D) {
+        xmin = det.box.xmin; ymin = det.box.ymin; xmax = det.box.xmax; ymax = det.box.ymax;
+        return true;
+    }
+    if (!has_position(det.box3d)) return false;
+    bev_extent(det.box3d, xmin, ymin, xmax, ymax);
+    if (metric == ASSOC_CENTER_DISTANCE) {
+        xmin -= MAX_CENTER_DISTANCE; ymin -= MAX_CENTER_DISTANCE;
+        xmax += MAX_CENTER_DISTANCE; ymax += MAX_CENTER_DISTANCE;
+    }
+    return true;
+}
+/*****************************************************
+*功能：两个检测的关联值，越大越好，不小于association_threshold时可以关联
+*****************************************************/
+static double association_score(const detection_cam& prev, const detection_cam& curr, const AssociationMetric metric) {
+    switch (metric) {
+        case ASSOC_IOU_BEV: return bev_iou(prev.box3d, curr.box3d);
+        case ASSOC_CENTER_DISTANCE: return MAX_CENTER_DISTANCE - center_distance(prev.box3d, curr.box3d);
+        default: return IoU(prev.box, curr.box);
+    }
+}
+static double association_threshold(const AssociationMetric metric) {
+    switch (metric) {
+        case ASSOC_IOU_BEV: return MIN_BEV_IoU;
+        case ASSOC_CENTER_DISTANCE: return 0;
+        default: return MIN_IoU;
+    }
+}
+/*****************************************************
+*功能：两帧检测结果的匹配，创建新物体，更新物体的轨迹。
+*先按匀速模型预测所有物体的位置；当前帧检测框登记到网格中（图像空间或鸟瞰图），
+*前一帧的每个检测只与共享网格、且落在预测位置门限内的检测计算关联值，
+*按前一帧的顺序贪心匹配。未检出的物体（包括当前帧没有检测时）按预测位置继续保留至多MISSED_FRAME帧
 *输入：
 *detectPrev: 前一帧的检测结果
 *detectCurr: 当前帧的检测结果
 *objectList： 存储生命周期内的物体
+*dt: 两帧的时间间隔，秒
+*metric: 关联代价，鸟瞰图度量只使用三维检测框，不依赖图像检测
 *****************************************************/
-void Hungaria(LinkList<detection_cam> detectPrev, LinkList<detection_cam>& detectCurr, ObjectList* objectList) {
+void Hungaria(LinkList<detection_cam> detectPrev, LinkList<detection_cam>& detectCurr, ObjectList* objectList,
+              const float dt, const AssociationMetric metric) {
+    objectList->predict(dt);
+    // an empty current frame still coasts and ages every track of the previous frame
     if (detectPrev.count()) {
-        // 计算关联值
-        double maxIoU = MIN_IoU;
-        int flag = -1;
-        size_t j_max = detectCurr.count();
-        // 选择关联值最大且大于阈值的两个检测并将之关联起来
-        if (j_max) {
-            for (size_t j = 0; j < j_max; j++) {
-                detection_cam prev;
-                detection_cam curr;
-                if (detectPrev.getItem(0, prev) && detectCurr.getItem(j, curr)) {
-                    if(!curr.id) {
-                        double tmp = IoU(prev.box, curr.box);
-                        if (tmp >= maxIoU) { maxIoU = tmp; flag = j;}}}
+        // 登记当前帧检测，关联值超过阈值的检测框必然共享网格
+        std::vector<detection_cam*> current;
+        current.reserve(detectCurr.count());
+        detectCurr.forEach([&current](detection_cam& curr) {current.push_back(&curr);});
+        GatingGrid grid(metric == ASSOC_IOU_2D ? GATING_CELL_SIZE : GATING_BEV_CELL_SIZE);
+        float xmin, ymin, xmax, ymax;
+        for (size_t j = 0; j < current.size(); j++)
+            if (association_extent(*current[j], metric, xmin, ymin, xmax, ymax)) grid.insert(xmin, ymin, xmax, ymax, j);
+
+        std::vector<size_t> candidates;
+        const double threshold = association_threshold(metric);
+        detectPrev.forEach([&](detection_cam& prev) {
+            // 选择关联值最大且大于阈值的两个检测并将之关联起来
+            double maxScore = threshold;
+            detection_cam* match = nullptr;
+            candidates.clear();
+            if (association_extent(prev, metric, xmin, ymin, xmax, ymax)) grid.query(xmin, ymin, xmax, ymax, candidates);
+            for (size_t j : candidates) {
+                detection_cam* curr = current[j];
+                // only detections near the predicted position are scored
+                if (!curr->id && objectList->inGate(prev.id, curr->box3d)) {
+                    double tmp = association_score(prev, *curr, metric);
+                    if (tmp >= maxScore) {maxScore = tmp; match = curr;}
+                }
             }
-            detection_cam* ptrDetectPrev = &detectPrev.getItem(0);
             // 判断前一帧物体是否在下一帧中检测出，如检出则添加至对应物体的轨迹中
-            if(flag >= 0) {
-                detection_cam* ptrDetectCurr = &detectCurr.getItem(flag);
-                ptrDetectCurr->id = ptrDetectPrev->id;
-                objectList->addTrack(ptrDetectCurr->id, *ptrDetectCurr);
-                // renew dimension
-                //Object* ptrObject = objectList->getObject(ptrDetectCurr->id);
-                //float length_renewed, width_renewed, height_renewed;
-                //ptrObject->getDimension(length_renewed, width_renewed, height_renewed);
-                //renewBox3d(ptrDetectCurr->box3d, length_renewed, width_renewed, height_renewed);
-                //std::cout << "New track added to: " << ptrDetectPrev->id << '\t' << maxIoU  << '\t' << flag << std::endl;
+            if (match) {
+                match->id = prev.id;
+                // the published and logged box takes the smoothed dimensions of the track
+                if (objectList->addTrack(match->id, *match) && has_position(match->box3d))
+                    renewBox3d(match->box3d, *objectList->getObject(match->id));
+                //std::cout << "New track added to: " << prev.id << '\t' << maxScore << std::endl;
             } else {
-                // 未检出达到一定帧数则从列表中删除该物体
-                detection_cam prev;
-                detectPrev.getItem(0, prev);
+                // 未检出达到一定帧数则从列表中删除该物体，之前按预测位置保留
                 prev.miss++;
-                if (prev.miss <= MISSED_FRAME) detectCurr.addItem(prev);
-                else {
-                    objectList->delID(ptrDetectPrev->id);
-                    //std::cout << "Object deleted with ID: " << ptrDetectPrev->id << std::endl;
+                float px, py;
+                if (has_position(prev.box3d) && objectList->getEngine().getPosition(prev.id, px, py)) {
+                    prev.box3d.corner_x += px - prev.box3d.pos.x;
+                    prev.box3d.corner_y += py - prev.box3d.pos.y;
+                    prev.box3d.pos.x = px;
+                    prev.box3d.pos.y = py;
                 }
-            }
-            detectPrev.delItem(0);
-            Hungaria(detectPrev, detectCurr, objectList);
-        }
-    }
-    else if (detectCurr.count()) {
-        // 创建新物体，并分配trackID给对应检测数据
-        for (size_t i = 0; i < detectCurr.count(); i++) {
-            detection_cam* ptrDetect = &detectCurr.getItem(i);
-            if(!ptrDetect->id) {
-                ptrDetect->id = nextID;
-                Object* newCar = new Object(nextID);
-                detection_cam tmp;
-                if(detectCurr.getItem(i,tmp))
-                    newCar->addItem(tmp);
-                nextID++;
-                objectList->addItem(*newCar);
-                //std::cout << "New object created with ID: " << newCar->getTrackID() << std::endl;
-                delete newCar;
-            }
-        }
-    }
-}
-/*
-void Hungaria(LinkList<detection_cam> detectPrev, LinkList<detection_cam>& detectCurr, ObjectList* objectList) {
-    if (detectPrev.count()) {
-        // 计算关联值
-        double maxIoU = MIN_IoU;
-        int flag = -1;
-        int j_max = detectCurr.count();
-        // 选择关联值最大且大于阈值的两个检测并将之关联起来
-        if (j_max) {
-            for (int j = 0; j < j_max; j++) {
-                detection_cam prev;
-                detection_cam curr;
-                if (detectPrev.getItem(0, prev) && detectCurr.getItem(j, curr)) {
-                    if(!curr.id) {
-                        double tmp = IoU(prev.box, curr.box);
-                        if (tmp >= maxIoU) {
-                            maxIoU = tmp;
-                            flag = j;
-                        }
-                    }
+                // a coasting track that no longer fits in the frame is dropped with its state
+                if (prev.miss > MISSED_FRAME || !detectCurr.addItem(prev)) {
+                    objectList->delID(prev.id);
+                    //std::cout << "Object deleted with ID: " << prev.id << std::endl;
                 }
             }
-            detection_cam* ptrDetectPrev = &detectPrev.getItem(0);
-            // 判断前一帧物体是否在下一帧中检测出，如检出则添加至对应物体的轨迹中
-            if(flag >= 0) {
-                detection_cam* ptrDetectCurr = &detectCurr.getItem(flag);
-                ptrDetectCurr->id = ptrDetectPrev->id;
-                objectList->addTrack(ptrDetectCurr->id, *ptrDetectCurr);
-                std::cout << "New track added to: " << ptrDetectPrev->id << '\t' << maxIoU  << '\t' << flag << std::endl;
-            } else {
-                // 未检出则从列表中删除该物体
-                objectList->delID(ptrDetectPrev->id);
-                std::cout << "Object deleted with ID: " << ptrDetectPrev->id << std::endl;
-            }
-            detectPrev.delItem(0);
-            Hungaria(detectPrev, detectCurr, objectList);
-        }
+        });
     }
-    else if (detectCurr.count()) {
+    if (detectCurr.count()) {
         // 创建新物体，并分配trackID给对应检测数据
-        for (int i = 0; i < detectCurr.count(); i++) {
-            detection_cam* ptrDetect = &detectCurr.getItem(i);
-            if(!ptrDetect->id) {
-                ptrDetect->id = nextID;
-                Object* newCar = new Object(nextID);
-                detection_cam tmp;
-                if(detectCurr.getItem(i,tmp))
-                    newCar->addItem(tmp);
+        detectCurr.forEach([objectList](detection_cam& curr) {
+            if (!curr.id) {
+                curr.id = nextID;
+                objectList->newTrack(nextID, curr);
                 nextID++;
-                objectList->addItem(*newCar);
-                std::cout << "New object created with ID: " << newCar->getTrackID() << std::endl;
-                delete newCar;
+                //std::cout << "New object created with ID: " << nextID - 1 << std::endl;
             }
-        }
+        });
     }
+    objectList->update();
 }
-*/
-
 /*****************************************************
 *功能：计算两帧检测结果的关联矩阵
 *输入：
@@ -263,7 +339,7 @@ void corrMatrix(LinkList<detection_cam>& detectPrev, LinkList<detection_cam>& de
 *输出：
 *IoU数值
 *****************************************************/
-double IoU(const Box2d prev_box, const Box2d curr_box) {
+double IoU(const Box2d& prev_box, const Box2d& curr_box) {
     double prev_center_x = (prev_box.xmax +  prev_box.xmin) / 2;
     double prev_center_y = (prev_box.ymax +  prev_box.ymin) / 2;
     double prev_length = prev_box.xmax -  prev_box.xmin;
@@ -288,9 +364,7 @@ double IoU(const Box2d prev_box, const Box2d curr_box) {
 *功能：更新三维检测框，引入跟踪信息
 *输入：
 *box3d: 将同于更新的三维检测框
-*length: 当前帧的一个检测结果
-*输出：
-*IoU数值
+*length/width/height: 跟踪得到的尺寸
 *****************************************************/
 void renewBox3d(Box3d &box3d, const float length, const float width, const float height) {
     float theta = box3d.heading;
@@ -303,3 +377,17 @@ void renewBox3d(Box3d &box3d, const float length, const float width, const float
     box3d.width = width;
     box3d.height = height;
 }
+/*****************************************************
+*功能：以物体尺寸的指数平滑值更新三维检测框，与轨迹长度无关
+*输入：
+*box3d: 将同于更新的三维检测框
+*object: 检测所属的物体
+*输出：
+*false: 物体还没有点云拟合得到的尺寸，检测框不变
+*****************************************************/
+bool renewBox3d(Box3d &box3d, const Object& object) {
+    float length, width, height;
+    if (!object.getSmoothedDimension(length, width, height)) return false;
+    renewBox3d(box3d, length, width, height);
+    return true;
+}
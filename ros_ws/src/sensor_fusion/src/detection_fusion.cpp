@@ -1,30 +1,81 @@
 #include "sensor_fusion/detection_fusion.h"
+#include "sensor_fusion/CloudCache.h"
+#include "sensor_fusion/Profiler.h"
 /*****************************************************
 *功能：初始化标志置零
 *****************************************************/
-detection_fusion::detection_fusion() : ptrObjFrame(new LinkList<detection_obj>(20)) {is_initialized = false;}
+template<typename Rig>
+BasicDetectionFusion<Rig>::BasicDetectionFusion() : ptrObjFrame(new LinkList<detection_obj>(20)) {is_initialized = false;}
 /*****************************************************
 *功能：释放内存
 *****************************************************/
-detection_fusion::~detection_fusion(){}
+template<typename Rig>
+BasicDetectionFusion<Rig>::~BasicDetectionFusion(){}
 /*****************************************************
 *功能：返回初始化标志位
 *****************************************************/
-bool detection_fusion::Is_initialized() {return is_initialized;}
+template<typename Rig>
+bool BasicDetectionFusion<Rig>::Is_initialized() {return is_initialized;}
 /*****************************************************
 *功能：传入初始化数据
 *输入：
 *point_projection_matrix_: 激光雷达到相机的外部参数
 *DetectFrame: 用于储存一帧检测结果，用于后续追踪匹配
-*BBoxes_msg: 图像二维检测单帧检测框结果
+*BBoxes: 图像二维检测单帧车辆检测框结果
+*Objs: 图像二维检测单帧其他障碍物检测框结果
 *in_cloud_: 对应帧原始点云
 *****************************************************/
-void detection_fusion::Initialize(LinkList<detection_cam> &DetectFrame, 
-                                  const darknet_ros_msgs::msg::BoundingBoxes::ConstPtr& BBoxes_msg,
-                                  const darknet_ros_msgs::msg::BoundingBoxes::ConstPtr& Objs_msg,
+template<typename Rig>
+void BasicDetectionFusion<Rig>::Initialize(LinkList<detection_cam> &DetectFrame, 
+                                  const Boxes2d& BBoxes,
+                                  const Boxes2d& Objs,
                                   const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_,
                                   const Matrix34d P, const Matrix3d R, const Matrix31d T) {
-    // Initialize calibration parameters
+    initialize_calibration(P, R, T);
+
+    // Initialize detetction list
+    boxes2d = BBoxes;
+    objs2d = Objs;
+    inCloud = in_cloud_;
+    ptrDetectFrame = &DetectFrame;
+    initialize_list();
+    project_cloud(PointCloudView(*inCloud));
+
+    is_initialized = true;
+}
+/*****************************************************
+*功能：传入初始化数据，点云与其投影取自共享的预处理点云缓存
+*输入：
+*DetectFrame: 用于储存一帧检测结果，用于后续追踪匹配
+*BBoxes: 图像二维检测单帧车辆检测框结果
+*Objs: 图像二维检测单帧其他障碍物检测框结果
+*cloud: 对应帧的预处理点云，相同标定的投影只计算一次
+*****************************************************/
+template<typename Rig>
+void BasicDetectionFusion<Rig>::Initialize(LinkList<detection_cam> &DetectFrame, 
+                                  const Boxes2d& BBoxes,
+                                  const Boxes2d& Objs,
+                                  PreprocessedCloud& cloud,
+                                  const Matrix34d P, const Matrix3d R, const Matrix31d T) {
+    initialize_calibration(P, R, T);
+
+    boxes2d = BBoxes;
+    objs2d = Objs;
+    inCloud = cloud.groundOffCloud;
+    ptrDetectFrame = &DetectFrame;
+    initialize_list();
+    {
+        PROFILE_SCOPE(PROF_PROJECT_CLOUD);
+        projection = cloud.projection(point_projection_matrix, Rig::frustum_near);
+    }
+
+    is_initialized = true;
+}
+/*****************************************************
+*功能：由相机内参与激光雷达到相机的外参计算投影与反投影矩阵
+*****************************************************/
+template<typename Rig>
+void BasicDetectionFusion<Rig>::initialize_calibration(const Matrix34d& P, const Matrix3d& R, const Matrix31d& T) {
     Matrix4d spatial_trans = Matrix4d::Zero();
     for(size_t a = 0; a < 3; a++)
         for(size_t b = 0; b < 3; b++)
@@ -36,20 +87,12 @@ void detection_fusion::Initialize(LinkList<detection_cam> &DetectFrame,
     point_projection_matrix = P*spatial_trans;
     back_projection_R = R.transpose()*P.block(0,0,3,3).inverse();
     back_projection_T = R.transpose()*T;
-
-    // Initialize detetction list
-    boxes2d = BBoxes_msg->bounding_boxes;
-    objs2d = Objs_msg->bounding_boxes;
-    inCloud = in_cloud_->makeShared();
-    ptrDetectFrame = &DetectFrame;
-    initialize_list();
-
-    is_initialized = true;
 }
 /*****************************************************
 *功能：将2D检测结果分组分层，依次处理前景障碍物与车辆点云
 *****************************************************/
-void detection_fusion::extract_feature() {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::extract_feature() {
     occlusion_table_calc();
     seperate_into_group();
     
@@ -65,7 +108,8 @@ void detection_fusion::extract_feature() {
 /*****************************************************
 *功能：初始化储存检测的两个list
 *****************************************************/
-void detection_fusion::initialize_list() {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::initialize_list() {
     std::sort(boxes2d.begin(), boxes2d.end(), [](const Box2d& box_1, const Box2d& box_2) {return box_1.ymax > box_2.ymax;});
     for(auto it = boxes2d.begin(); it != boxes2d.end(); it++) {
         detection_cam* ptr_det (new detection_cam);
@@ -79,27 +123,66 @@ void detection_fusion::initialize_list() {
     }
 }
 /*****************************************************
+*功能：将点云一次性投影到图像平面，供各检测框的视锥剪裁复用
+*输入：
+*in_view: 点云视图，序号与inCloud一致
+*****************************************************/
+template<typename Rig>
+void BasicDetectionFusion<Rig>::project_cloud(const PointCloudView &in_view) {
+    PROFILE_SCOPE(PROF_PROJECT_CLOUD);
+    std::shared_ptr<CloudProjection> cloud_projection(new CloudProjection);
+    project_into_image(in_view, point_projection_matrix, Rig::frustum_near, *cloud_projection);
+    projection = cloud_projection;
+}
+/*****************************************************
+*功能：将点云投影到图像平面
+*输入：
+*in_view: 点云视图
+*point_projection_matrix: 激光雷达坐标到图像齐次坐标的投影矩阵
+*near: 相机光轴方向上深度小于该距离的点不投影，对任意朝向的相机都适用
+*out_projection: 各点的图像坐标与有效标志
+*****************************************************/
+void project_into_image(const PointCloudView &in_view, const Matrix34d& point_projection_matrix, const double near,
+                        CloudProjection& out_projection) {
+    out_projection.uv.assign(in_view.size(), Point2D());
+    out_projection.valid.assign(in_view.size(), 0);
+    const Eigen::Matrix<double, 3, 3> M = point_projection_matrix.block<3,3>(0,0);
+    const Eigen::Matrix<double, 3, 1> t = point_projection_matrix.block<3,1>(0,3);
+    for (size_t i = 0; i < in_view.size(); i++) {
+        Eigen::Matrix<double, 3, 1> pointPic = M * Eigen::Matrix<double, 3, 1>(in_view.x(i), in_view.y(i), in_view.z(i)) + t;
+        // pointPic(2) is the depth along the camera axis
+        if (pointPic(2,0) > near) {
+            out_projection.uv[i].x = pointPic(0,0)/pointPic(2,0);
+            out_projection.uv[i].y = pointPic(1,0)/pointPic(2,0);
+            out_projection.valid[i] = 1;
+        }
+    }
+}
+/*****************************************************
 *功能：计算表示遮挡关系的表格用于后续查询
 *****************************************************/
-void detection_fusion::occlusion_table_calc() {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::occlusion_table_calc() {
+    PROFILE_SCOPE(PROF_OCCLUSION_TABLE);
     // occlusion between vehicles and vehicles
     for(size_t i = 0; i < boxes2d.size(); i++) {
         occlusion_table.push_back(std::vector<bool> {});
         for(size_t j = i+1; j < boxes2d.size(); j++)
-            occlusion_table[i].push_back(IoU_bool(boxes2d[i], boxes2d[j]));
+            occlusion_table[i].push_back(IoU_bool<Rig>(boxes2d[i], boxes2d[j]));
     }
 
     // occlusion between objects and vehicles
     for(size_t i = 0; i < objs2d.size(); i++) {
         occlusion_table.push_back(std::vector<bool> {});
         for(size_t j = 0; j < boxes2d.size(); j++)
-            occlusion_table[boxes2d.size()+i].push_back(IoU_bool(objs2d[i], boxes2d[j]));
+            occlusion_table[boxes2d.size()+i].push_back(IoU_bool<Rig>(objs2d[i], boxes2d[j]));
     }
 }
 /*****************************************************
 *功能：对车辆检测结果进行分组分层
 *****************************************************/
-void detection_fusion::seperate_into_group() {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::seperate_into_group() {
     // seperate into groups by occlusion
     std::vector<std::unordered_set<size_t>> group_all;
     size_t all_size = 0;
@@ -134,20 +217,13 @@ void detection_fusion::seperate_into_group() {
 *outCloud: 剪切后的点云
 *fruIndices: 剪切后的点云的检索序号
 *****************************************************/
-void detection_fusion::clip_frustum(const Box2d box2d, pcl::PointCloud<pcl::PointXYZI>::Ptr &outCloud, pcl::PointIndices& fruIndices) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::clip_frustum(const Box2d& box2d, pcl::PointCloud<pcl::PointXYZI>::Ptr &outCloud, pcl::PointIndices& fruIndices) {
+    PROFILE_SCOPE(PROF_CLIP_FRUSTUM);
     for (size_t i = 0; i < inCloud->points.size(); i++) {
-        // Project point in lidar coordinate into image in specific camera
-        double x = inCloud->points[i].x;
-        if(x > 3) {
-            double y = inCloud->points[i].y;
-            double z = inCloud->points[i].z;
-            Eigen::Matrix<double, 4, 1> point3D;
-            point3D << x,y,z,1;
-            Eigen::Matrix<double, 3, 1> pointPic = point_projection_matrix * point3D;
-            // check whether the point is in the detection
-            if(in_frustum(pointPic(0,0)/pointPic(2,0), pointPic(1,0)/pointPic(2,0), box2d))
-                fruIndices.indices.push_back(i);
-        }
+        // check whether the projected point is in the detection
+        if(projection->valid[i] && in_frustum(projection->uv[i].x, projection->uv[i].y, box2d))
+            fruIndices.indices.push_back(i);
     }
     pcl::ExtractIndices<pcl::PointXYZI> cliper;
     cliper.setInputCloud(inCloud);
@@ -162,10 +238,15 @@ void detection_fusion::clip_frustum(const Box2d box2d, pcl::PointCloud<pcl::Poin
 *outCloud: 剪切后的点云
 *fruIndices: 剪切后的点云的检索序号
 *****************************************************/
-void detection_fusion::clip_frustum_with_overlap(const size_t num, pcl::PointCloud<pcl::PointXYZI>::Ptr &outCloud, pcl::PointIndices& fruIndices) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::clip_frustum_with_overlap(const size_t num, pcl::PointCloud<pcl::PointXYZI>::Ptr &outCloud, pcl::PointIndices& fruIndices) {
+    PROFILE_SCOPE(PROF_CLIP_FRUSTUM);
+    const Eigen::Matrix<double, 1, 4> depth_row = point_projection_matrix.row(2);
     for (size_t i = 0; i < inCloud->points.size(); i++) {
-        // Project point in lidar coordinate into image in specific camera
-        if(inCloud->points[i].x > 5) {
+        // Depth of the point along the camera axis, same as the homogeneous coordinate of its projection
+        const pcl::PointXYZI& point = inCloud->points[i];
+        double depth = depth_row(0) * point.x + depth_row(1) * point.y + depth_row(2) * point.z + depth_row(3);
+        if(depth > Rig::frustum_overlap_near && projection->valid[i]) {
             // check whether the point is in the detection
             if(in_frustum_overlap(i, num))
                 fruIndices.indices.push_back(i);
@@ -184,7 +265,8 @@ void detection_fusion::clip_frustum_with_overlap(const size_t num, pcl::PointClo
 *u: 投影后在图像上的v坐标
 *box2d: 二维检测框
 *****************************************************/
-bool detection_fusion::in_frustum(const double u, const double v, const Box2d box) {
+template<typename Rig>
+bool BasicDetectionFusion<Rig>::in_frustum(const double u, const double v, const Box2d& box) {
     if (u >= box.xmin && u <= box.xmax && v >= box.ymin && v <= box.ymax)
         return true;
     else
@@ -196,15 +278,10 @@ bool detection_fusion::in_frustum(const double u, const double v, const Box2d bo
 *cloud_indices: 点云的检索序号
 *num: 二维检测框的序号
 *****************************************************/
-bool detection_fusion::in_frustum_overlap(const size_t cloud_indice, const size_t num) {
-    Eigen::Matrix<double, 4, 1> point3D;
-    double x = inCloud->points[cloud_indice].x;
-    double y = inCloud->points[cloud_indice].y;
-    double z = inCloud->points[cloud_indice].z;
-    point3D << x,y,z,1;
-    Eigen::Matrix<double, 3, 1> pointPic = point_projection_matrix * point3D;
-    double u = pointPic(0,0)/pointPic(2,0);
-    double v = pointPic(1,0)/pointPic(2,0);
+template<typename Rig>
+bool BasicDetectionFusion<Rig>::in_frustum_overlap(const size_t cloud_indice, const size_t num) {
+    double u = projection->uv[cloud_indice].x;
+    double v = projection->uv[cloud_indice].y;
     std::vector<Box2d>::iterator it = boxes2d.begin() + num;
     if(in_frustum(u, v, *it)) {
         auto it_overlap = overlap_area.begin();
@@ -236,7 +313,8 @@ bool detection_fusion::in_frustum_overlap(const size_t cloud_indice, const size_
 *输出：
 *overlap: 重合部分检测框
 *****************************************************/
-Box2d detection_fusion::overlap_box(const Box2d prev_box, const Box2d curr_box) {
+template<typename Rig>
+Box2d BasicDetectionFusion<Rig>::overlap_box(const Box2d& prev_box, const Box2d& curr_box) {
     Box2d overlap;
     double prev_center_x = (prev_box.xmax +  prev_box.xmin) / 2;
     double prev_center_y = (prev_box.ymax +  prev_box.ymin) / 2;
@@ -326,10 +404,12 @@ Box2d detection_fusion::overlap_box(const Box2d prev_box, const Box2d curr_box)
 *输出：
 *cloud_cluster: 聚类后的最大点云
 *****************************************************/
-bool detection_fusion::eu_cluster(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud, 
+template<typename Rig>
+bool BasicDetectionFusion<Rig>::eu_cluster(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud, 
                                   const pcl::PointIndices fruIndices,
                                   pcl::PointCloud<pcl::PointXYZI>::Ptr cloud_cluster,
                                   pcl::PointIndices& objIndices) {
+    PROFILE_SCOPE(PROF_EU_CLUSTER);
     // Data containers used
     pcl::PointCloud<pcl::PointXYZINormal>::Ptr cloud_with_normals(new pcl::PointCloud<pcl::PointXYZINormal>);
     //pcl::PointCloud<pcl::PointXYZI>::Ptr cloud_cluster(new pcl::PointCloud<pcl::PointXYZI>);
@@ -393,7 +473,8 @@ bool customRegionGrowing(const pcl::PointXYZINormal& point_a, const pcl::PointXY
 *输出:
 返回拟合误差，若不满足拟合条件返回0
 *****************************************************/
-double detection_fusion::Lshape(pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrCarCloud,
+template<typename Rig>
+double BasicDetectionFusion<Rig>::Lshape(pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrCarCloud,
                                 pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrSgroup,
                                 Matrix51f &u) {
     PointCloudXYZIRT Sgroup_;
@@ -413,7 +494,7 @@ double detection_fusion::Lshape(pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrCarClou
     // sorting by ascending theta
     std::sort(Sgroup_.begin(), Sgroup_.end(), 
               [](const PointXYZIRT &a, const PointXYZIRT &b) { return a.theta < b.theta; });
-    if (Sgroup_.size() > S_GROUP_THRESHOLD) {
+    if (Sgroup_.size() > Rig::s_group_threshold) {
         Lproposal(Sgroup_, ptrSgroup);
 
         // Create the filtering object
@@ -424,13 +505,13 @@ double detection_fusion::Lshape(pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrCarClou
         sor.setStddevMulThresh(1);
         sor.filter (*ptrSgroup);*/
 
-        if (ptrSgroup->size() > S_GROUP_THRESHOLD) {
+        if (ptrSgroup->size() > Rig::s_group_threshold) {
             //for(size_t i = 0; i < 0; i++) {
             //    ptrSgroup->erase(ptrSgroup->end());
             //    ptrSgroup->erase(ptrSgroup->begin());
             //}
             //Eigen::Matrix<float,3,1> p;
-            if (ptrSgroup->size() > S_GROUP_REFINED_THRESHOLD) {
+            if (ptrSgroup->size() > Rig::s_group_refined_threshold) {
                 return Lfit(ptrSgroup, u);
             } else return 0;
         }
@@ -444,8 +525,9 @@ double detection_fusion::Lshape(pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrCarClou
 *carCloud: 语义分割后的车辆点云
 *box3d：用于存储三维检测结果
 *****************************************************/
-void detection_fusion::bounding_box_param(const Matrix51f u, const pcl::PointCloud<pcl::PointXYZI>::Ptr ptrSgroup, 
-                                          const pcl::PointCloud<pcl::PointXYZI>::Ptr carCloud, Box3d& box3d, const Box2d box) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::bounding_box_param(const Matrix51f u, const pcl::PointCloud<pcl::PointXYZI>::Ptr ptrSgroup, 
+                                          const pcl::PointCloud<pcl::PointXYZI>::Ptr carCloud, Box3d& box3d, const Box2d& box) {
     Point2D corner_point;
     Point2D point_1;
     Point2D point_2;
@@ -492,14 +574,15 @@ void detection_fusion::bounding_box_param(const Matrix51f u, const pcl::PointClo
 *输出：
 true/false: 是否计算成功
 *****************************************************/
-bool detection_fusion::box_corner_estimation(const Matrix51f u, Point2D &corner_point) {
+template<typename Rig>
+bool BasicDetectionFusion<Rig>::box_corner_estimation(const Matrix51f u, Point2D &corner_point) {
     float c1 = u(0,0);
     float c2 = u(1,0);
     float n1 = u(2,0);
     float n2 = u(3,0);
     // corner point
-    if(n2 != 0 && std::abs(n1/n2) < MIN_SLOPE) {corner_point.y = -c1/n2; corner_point.x = c2/n2;}
-    else if (n1 != 0 && std::abs(n2/n1) < MIN_SLOPE) {corner_point.y = -c2/n1; corner_point.x = -c1/n1;}
+    if(n2 != 0 && std::abs(n1/n2) < Rig::min_slope) {corner_point.y = -c1/n2; corner_point.x = c2/n2;}
+    else if (n1 != 0 && std::abs(n2/n1) < Rig::min_slope) {corner_point.y = -c2/n1; corner_point.x = -c1/n1;}
     else if (n1 != 0 && n1 != 0) {
         corner_point.x = (n2*c2-n1*c1)/(n2*n2 + n1*n1);
         corner_point.y = -n1/n2*corner_point.x-c1/n2;
@@ -519,7 +602,8 @@ bool detection_fusion::box_corner_estimation(const Matrix51f u, Point2D &corner_
 *输出：
 length_max: 投影后的最大尺寸
 *****************************************************/
-float detection_fusion::box_point_estimation(const float k, const float b, const size_t cloud_start, const size_t cloud_end,
+template<typename Rig>
+float BasicDetectionFusion<Rig>::box_point_estimation(const float k, const float b, const size_t cloud_start, const size_t cloud_end,
                                              const pcl::PointCloud<pcl::PointXYZI>::Ptr cloud_in, const Point2D corner_point, Point2D& point) {
     float length_max = 0;
     for (size_t i = cloud_start; i < cloud_end; i++) {
@@ -546,7 +630,8 @@ float detection_fusion::box_point_estimation(const float k, const float b, const
 *输出：
 true/false: 是否计算成功
 *****************************************************/
-bool detection_fusion::box_point_estimation(const Matrix51f u, const Point2D corner_point, const Box2d box, 
+template<typename Rig>
+bool BasicDetectionFusion<Rig>::box_point_estimation(const Matrix51f u, const Point2D corner_point, const Box2d& box, 
                                             Point2D &point_1, Point2D &point_3) {
     float c1 = u(0,0);
     float c2 = u(1,0);
@@ -576,7 +661,8 @@ bool detection_fusion::box_point_estimation(const Matrix51f u, const Point2D cor
 *输出：
 true/false: 是否计算成功
 *****************************************************/
-bool detection_fusion::line_intersection(const float k1, const float b1, const float k2, const float b2, Point2D &point) {
+template<typename Rig>
+bool BasicDetectionFusion<Rig>::line_intersection(const float k1, const float b1, const float k2, const float b2, Point2D &point) {
     if(k1 == k2) return false;
     point.x = (b2-b1)/(k1-k2);
     point.y = k1*point.x+b1;
@@ -590,7 +676,8 @@ bool detection_fusion::line_intersection(const float k1, const float b1, const f
 *slope: 用于储存直线的斜率
 *b: 用于储存直线的截距
 *****************************************************/
-void detection_fusion::uv_projection_into_xy(const float u, const float v, float &slope, float &b) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::uv_projection_into_xy(const float u, const float v, float &slope, float &b) {
     Eigen::Matrix<double, 3, 1> point2D;
     Eigen::Matrix<double, 3, 1> k;
     Eigen::Matrix<double, 3, 1> k_max;
@@ -605,14 +692,15 @@ void detection_fusion::uv_projection_into_xy(const float u, const float v, float
 *Sgroup_: 根据角度排序的点云
 *ptrSgroup：筛选出的点云
 *****************************************************/
-void detection_fusion::Lproposal(const PointCloudXYZIRT Sgroup_, pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrSgroup){
+template<typename Rig>
+void BasicDetectionFusion<Rig>::Lproposal(const PointCloudXYZIRT Sgroup_, pcl::PointCloud<pcl::PointXYZI>::Ptr &ptrSgroup){
     float theta = Sgroup_[0].theta;
     float theta_sum = 0;
     int num = 0;
     PointCloudXYZIRT tmp;
     // Picking L-shape fitting points according to theta and radius
     for (size_t i = 0; i < Sgroup_.size(); i++) {
-        if (abs(Sgroup_[i].theta - theta) < ANGLE_RESO) {
+        if (abs(Sgroup_[i].theta - theta) < Rig::angle_reso) {
             theta_sum += Sgroup_[i].theta;
             num++;
             theta = theta_sum/num;
@@ -620,7 +708,7 @@ void detection_fusion::Lproposal(const PointCloudXYZIRT Sgroup_, pcl::PointCloud
             if (i == Sgroup_.size() - 1) {
                 std::sort(tmp.begin(), tmp.end(), [](const PointXYZIRT &a, const PointXYZIRT &b){return a.radius < b.radius;});
                 int j = 0;
-                while (tmp.size() > POINT_NUM && j < POINT_NUM){
+                while (tmp.size() > Rig::point_num && j < Rig::point_num){
                     ptrSgroup->points.push_back(tmp[j].point);
                     j++;
                 } 
@@ -628,7 +716,7 @@ void detection_fusion::Lproposal(const PointCloudXYZIRT Sgroup_, pcl::PointCloud
         } else {
             std::sort(tmp.begin(), tmp.end(), [](const PointXYZIRT &a, const PointXYZIRT &b){return a.radius < b.radius;});
             int j = 0;
-            while (tmp.size() > POINT_NUM && j < POINT_NUM){
+            while (tmp.size() > Rig::point_num && j < Rig::point_num){
                 ptrSgroup->points.push_back(tmp[j].point);
                 j++;
             } 
@@ -640,7 +728,7 @@ void detection_fusion::Lproposal(const PointCloudXYZIRT Sgroup_, pcl::PointCloud
             if (i == Sgroup_.size() - 1) {
                 std::sort(tmp.begin(), tmp.end(), [](const PointXYZIRT &a, const PointXYZIRT &b){return a.radius < b.radius;});
                 size_t j = 0;
-                while (j < tmp.size() && j < POINT_NUM){
+                while (j < tmp.size() && j < Rig::point_num){
                     ptrSgroup->points.push_back(tmp[j].point);
                     j++;
                 }
@@ -656,7 +744,9 @@ void detection_fusion::Lproposal(const PointCloudXYZIRT Sgroup_, pcl::PointCloud
 *in_cloud: 用于拟合的点云
 *u：用于储存拟合后的直线参数
 *****************************************************/
-double detection_fusion::Lfit(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud, Matrix51f &u) {
+template<typename Rig>
+double BasicDetectionFusion<Rig>::Lfit(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud, Matrix51f &u) {
+    PROFILE_SCOPE(PROF_LFIT);
     float eigenVal = 10000;
     Eigen::Matrix<float, 2, 1> n;
     Eigen::Matrix<float, 2, 1> c;
@@ -703,7 +793,8 @@ double detection_fusion::Lfit(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_clou
 输出:
 *deltaM: 矩阵增量值
 *****************************************************/
-Matrix4f detection_fusion::deltaM_compute(const pcl::PointXYZI point) {
+template<typename Rig>
+Matrix4f BasicDetectionFusion<Rig>::deltaM_compute(const pcl::PointXYZI point) {
     float x = point.x;
     float y = point.y;
     Matrix4f deltaM;
@@ -721,7 +812,8 @@ Matrix4f detection_fusion::deltaM_compute(const pcl::PointXYZI point) {
 *k：直线斜率
 *b：直线横截率
 *****************************************************/
-void detection_fusion::point_projection_into_line(float &x, float &y, const float k, const float b) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::point_projection_into_line(float &x, float &y, const float k, const float b) {
     x = (k*(y-b)+x)/(k*k+1);
     y = k*x+b;
 }
@@ -730,7 +822,8 @@ void detection_fusion::point_projection_into_line(float &x, float &y, const floa
 *输入：
 *num: 前景障碍物序号
 *****************************************************/
-void detection_fusion::obstacle_extract(const size_t num) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::obstacle_extract(const size_t num) {
     std::vector<Box2d>::iterator it = objs2d.begin() + num;
     detection_obj* ptr_det = ptrObjFrame->getPtrItem(num);
     pcl::PointCloud<pcl::PointXYZI>::Ptr fruCloud (new pcl::PointCloud<pcl::PointXYZI>);
@@ -758,9 +851,10 @@ void detection_fusion::obstacle_extract(const size_t num) {
 *输入：
 *num: 前景障碍物序号
 *****************************************************/
-void detection_fusion::vehicle_extract(const size_t num) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::vehicle_extract(const size_t num) {
     std::vector<Box2d>::iterator it = boxes2d.begin() + num;
-    //if (it->xmin > 0 && it->ymin > 0 && it->xmax < IMG_LENGTH && it->ymax < IMG_WIDTH) {
+    //if (it->xmin > 0 && it->ymin > 0 && it->xmax < Rig::img_length && it->ymax < Rig::img_width) {
     //detection_cam* ptr_det (new detection_cam);
     detection_cam* ptr_det = ptrDetectFrame->getPtrItem(num);
     pcl::PointCloud<pcl::PointXYZI>::Ptr fruCloud (new pcl::PointCloud<pcl::PointXYZI>);
@@ -812,7 +906,7 @@ void detection_fusion::vehicle_extract(const size_t num) {
 /*
 void detection_fusion::vehicle_extract(const int num) {
     std::vector<Box2d>::iterator it = boxes2d.begin() + num;
-    //if (it->xmin > 0 && it->ymin > 0 && it->xmax < IMG_LENGTH && it->ymax < IMG_WIDTH) {
+    //if (it->xmin > 0 && it->ymin > 0 && it->xmax < Rig::img_length && it->ymax < Rig::img_width) {
     detection_cam* ptr_det (new detection_cam);
     pcl::PointCloud<pcl::PointXYZI>::Ptr fruCloud (new pcl::PointCloud<pcl::PointXYZI>);
     pcl::PointCloud<pcl::PointXYZI>::Ptr carCloud (new pcl::PointCloud<pcl::PointXYZI>);
@@ -848,7 +942,8 @@ void detection_fusion::vehicle_extract(const int num) {
 *输出：
 *IoU数值
 *****************************************************/
-bool IoU_bool(const Box2d prev_box, const Box2d curr_box) {
+template<typename Rig>
+bool IoU_bool(const Box2d& prev_box, const Box2d& curr_box) {
     double prev_center_x = (prev_box.xmax +  prev_box.xmin) / 2;
     double prev_center_y = (prev_box.ymax +  prev_box.ymin) / 2;
     double prev_length = prev_box.xmax -  prev_box.xmin;
@@ -862,10 +957,11 @@ bool IoU_bool(const Box2d prev_box, const Box2d curr_box) {
     double len = (prev_length + curr_length)/2 -  std::abs(prev_center_x - curr_center_x);
     double wid = (prev_width + curr_width)/2 -  std::abs(prev_center_y - curr_center_y);
 
-    if(len > IOU_THRESHOLD*curr_length && wid > IOU_THRESHOLD*curr_width) return true;
+    if(len > Rig::iou_threshold*curr_length && wid > Rig::iou_threshold*curr_width) return true;
     else return false;
 }
-void detection_fusion::add_to_group(const std::vector<std::vector<bool>> occlusion_table, const int start, std::unordered_set<size_t>& group_set) {
+template<typename Rig>
+void BasicDetectionFusion<Rig>::add_to_group(const std::vector<std::vector<bool>> occlusion_table, const int start, std::unordered_set<size_t>& group_set) {
     group_set.insert(start);
     //std::cout << "group_member: " << start << std::endl;
     for(size_t i = 0; i < occlusion_table[start].size(); i++) {
@@ -877,6 +973,94 @@ void detection_fusion::add_to_group(const std::vector<std::vector<bool>> occlusi
         }
     }
 }
-Boxes2d detection_fusion::get_boxes(){
+template<typename Rig>
+Boxes2d BasicDetectionFusion<Rig>::get_boxes(){
     return overlap_area;
-}
\ No newline at end of file
+}
+
+/*****************************************************
+*功能：读取标定文件，依次为P（相机投影矩阵），R与T（激光雷达到相机的旋转与平移）
+*输入：
+*file_name: 标定文件路径
+*P/R/T: 输出的标定参数
+*****************************************************/
+bool read_calibration(const string& file_name, Matrix34d& P, Matrix3d& R, Matrix31d& T) {
+    std::ifstream input_file(file_name.c_str(), std::ifstream::in);
+    if(!input_file.is_open()) {std::cout << "Failed to open file. "  << std::endl; return false;}
+    // Reading parameters
+    string line;
+    for (int i = 0; i < 3; i++) {
+        std::stringstream iss;
+        string data_type;
+        getline(input_file, line);
+        iss << line;
+        iss >> data_type;
+        switch(data_type[0]) {
+            case 'P' :
+                for (int a = 0; a < 3; a++)
+                    for (int b = 0; b < 4; b++)
+                    iss >> P(a,b);
+                break;
+            case 'R' :
+                for (int a = 0; a < 3; a++)
+                    for (int b = 0; b < 3; b++)
+                        iss >> R(a,b);
+                break;
+            case 'T' :
+                iss >> T[0];
+                iss >> T[1];
+                iss >> T[2];
+                break;
+            default : 
+                std::cout << "Invalid parameter." << std::endl;
+                return false;
+        }
+    }
+    input_file.close();
+    return true;
+}
+
+/*****************************************************
+*功能：标记多个相机重叠视野中重复的检测结果。各相机的车辆点云索引均指向同一帧去地面点云，
+*与之前相机的某个检测共享的点数超过DEDUP_OVERLAP_RATIO（以较小的点云计）时视为同一物体，
+*保留序号较小相机的检测，其余标记为duplicate
+*输入：
+*camera_frames: 各相机的单帧检测结果，按相机顺序
+*cloud_size: 去地面点云的点数
+*输出：
+*标记为重复的检测数
+*****************************************************/
+size_t mark_cross_camera_duplicates(const std::vector<LinkList<detection_cam>*>& camera_frames, const size_t cloud_size) {
+    // owner of every ground-free point: camera in the high half, detection in the low half
+    std::vector<int64_t> owner(cloud_size, -1);
+    std::vector<std::vector<size_t>> owner_points(camera_frames.size());
+    size_t duplicates = 0;
+    for (size_t c = 0; c < camera_frames.size(); c++) {
+        LinkList<detection_cam>* frame = camera_frames[c];
+        owner_points[c].assign(frame->count(), 0);
+        for (size_t j = 0; j < frame->count(); j++) {
+            detection_cam* ptr_detect = frame->getPtrItem(j);
+            const std::vector<int>& indices = ptr_detect->indices.indices;
+            if (indices.empty()) continue;
+            std::map<int64_t, size_t> shared;
+            for (int i : indices)
+                if (i >= 0 && (size_t)i < cloud_size && owner[i] >= 0 && (size_t)(owner[i] >> 32) != c) shared[owner[i]]++;
+            for (const auto& s : shared) {
+                size_t owner_size = owner_points[s.first >> 32][s.first & 0xffffffff];
+                if (s.second >= DEDUP_OVERLAP_RATIO * std::min(indices.size(), owner_size)) {
+                    ptr_detect->duplicate = true;
+                    break;
+                }
+            }
+            if (ptr_detect->duplicate) {duplicates++; continue;}
+            int64_t key = ((int64_t)c << 32) | j;
+            for (int i : indices)
+                if (i >= 0 && (size_t)i < cloud_size) owner[i] = key;
+            owner_points[c][j] = indices.size();
+        }
+    }
+    return duplicates;
+}
+
+template class BasicDetectionFusion<KittiRig>;
+template bool IoU_bool<KittiRig>(const Box2d& prev_box, const Box2d& curr_box);
@@ -0,0 +1,228 @@
+/*************************************************************************
+*文件名：fusion_batch.cpp
+*功能：离线批处理，不经过ROS通信直接在KITTI序列上运行地面去除、视锥融合与跟踪，
+*尽可能快地处理所有帧并统计帧率，用于大量序列的回归测试。
+*读取、视锥融合与帧间状态无关，按块在多个线程中并行；时域地面模型与跟踪依赖前一帧，按帧顺序执行，
+*因此结果与-j/-c无关。--no-ground-model时地面去除也在多个线程中并行
+*用法：
+*fusion_batch <drive_dir> <calibration.txt> [-j threads] [-c chunk] [-s start] [-e end] [--no-ground-model]
+*             [--profile out.csv] [--metric iou_2d|bev_iou|center_distance]
+**************************************************************************/
+#include "sensor_fusion/GroundRemove.h"
+#include "sensor_fusion/detection_fusion.h"
+#include "sensor_fusion/Tracking.h"
+#include "sensor_fusion/Profiler.h"
+#include "kitti_pub/DetectionIndex.hpp"
+#include "kitti_pub/VelodyneBin.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#define BATCH_CHUNK 32          // frames processed in parallel before tracking
+
+typedef std::chrono::steady_clock batch_clock;
+
+/*************************************************************************
+*功能：单帧的批处理数据
+*************************************************************************/
+struct BatchFrame {
+    int index;
+    std::vector<uint8_t> bin;    // velodyne points as stored in the .bin file
+    pcl::PointCloud<pcl::PointXYZI>::Ptr groundOffCloud;
+    LinkList<detection_cam> detectFrame;
+    BatchFrame() : index(0), detectFrame(MAX_DETECT_PER_FRAME) {}
+};
+
+/*************************************************************************
+*功能：各阶段累计耗时，秒
+*************************************************************************/
+struct StageTime {
+    double load = 0;
+    double ground = 0;
+    double fusion = 0;
+    double tracking = 0;
+};
+
+static double seconds_since(const batch_clock::time_point start) {
+    return std::chrono::duration<double>(batch_clock::now() - start).count();
+}
+/*****************************************************
+*功能：将[0, count)按连续区间分给threads个线程，对每个k执行step(t, k)
+*****************************************************/
+template<typename Step>
+static void parallel_for(const int count, const int threads, Step step) {
+    auto worker = [&](const int t) {
+        for (int k = count * t / threads; k < count * (t + 1) / threads; k++) step(t, k);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : pool) th.join();
+}
+/*****************************************************
+*功能：去除一帧的地面点，释放原始点云
+*输入：
+*model: 时域地面模型，为空时逐帧独立分割
+*time: 累计耗时
+*****************************************************/
+static void remove_ground(BatchFrame& frame, GroundModel* model, StageTime& time) {
+    auto stage_start = batch_clock::now();
+    {
+        PROFILE_SCOPE(PROF_GROUND_REMOVE);
+        PointCloudView view(frame.bin.data(), frame.bin.size() / VELODYNE_POINT_STEP, 1,
+                            VELODYNE_POINT_STEP, frame.bin.size(), 0, 4, 8, 12);
+        GroundRemove groundOffCloud(view, model);
+        frame.groundOffCloud = groundOffCloud.ptrCloud;
+    }
+    std::vector<uint8_t>().swap(frame.bin);
+    time.ground += seconds_since(stage_start);
+}
+/*****************************************************
+*功能：生成补零的文件名，如0000000135.bin
+*****************************************************/
+static string frame_name(const int frame, const string& suffix) {
+    char name[32];
+    snprintf(name, sizeof(name), "%010d.%s", frame, suffix.c_str());
+    return name;
+}
+/*****************************************************
+*功能：取出一帧的检测结果，按车辆检测与其他障碍物检测分开，与kitti_pub发布的结果一致
+*输入：
+*detIndex: BoxInfo.txt的帧索引
+*det_boxes/obj_boxes: 输出的车辆检测与其他障碍物检测
+*****************************************************/
+static void boxes_of_frame(const DetectionIndex& detIndex, const int frame, Boxes2d& det_boxes, Boxes2d& obj_boxes) {
+    const KittiDetection* det = nullptr;
+    size_t det_count = detIndex.getFrame(frame, det);
+    for (size_t i = 0; i < det_count; i++, det++) {
+        // integer pixels like the BoundingBox messages the node receives
+        Box2d boundingBox;
+        int64_t corners[4];
+        detection_pixels(*det, KittiRig::img_length, KittiRig::img_width, corners);
+        boundingBox.obj_class = box_class_from_name(det->type.c_str());
+        boundingBox.probability = det->box[5];
+        boundingBox.xmin = corners[0];
+        boundingBox.ymin = corners[1];
+        boundingBox.xmax = corners[2];
+        boundingBox.ymax = corners[3];
+        if (is_vehicle_class(boundingBox.obj_class)) {
+            boundingBox.id = det_boxes.size();
+            det_boxes.push_back(boundingBox);
+        } else {
+            boundingBox.id = -1;
+            obj_boxes.push_back(boundingBox);
+        }
+    }
+}
+
+int main(int argc, char * argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: fusion_batch <drive_dir> <calibration.txt> [-j threads] [-c chunk] "
+                     "[-s start] [-e end] [--no-ground-model] [--profile out.csv] "
+                     "[--metric iou_2d|bev_iou|center_distance]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    string drive_dir = argv[1];
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int chunk = BATCH_CHUNK;
+    int start = 0, end = -1;
+    bool use_ground_model = true;
+    string profile_csv;
+    AssociationMetric metric = ASSOC_IOU_2D;
+    for (int a = 3; a < argc; a++) {
+        if (!strcmp(argv[a], "-j") && a + 1 < argc) threads = std::max(1, atoi(argv[++a]));
+        else if (!strcmp(argv[a], "-c") && a + 1 < argc) chunk = std::max(1, atoi(argv[++a]));
+        else if (!strcmp(argv[a], "-s") && a + 1 < argc) start = std::max(0, atoi(argv[++a]));
+        else if (!strcmp(argv[a], "-e") && a + 1 < argc) end = atoi(argv[++a]);
+        else if (!strcmp(argv[a], "--no-ground-model")) use_ground_model = false;
+        else if (!strcmp(argv[a], "--profile") && a + 1 < argc) profile_csv = argv[++a];
+        else if (!strcmp(argv[a], "--metric") && a + 1 < argc && !association_metric_from_name(argv[++a], metric)) {
+            std::cerr << "Unknown association metric " << argv[a] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    Profiler::instance().setEnabled(!profile_csv.empty());
+    Matrix34d P;
+    Matrix3d R;
+    Matrix31d T;
+    if (!read_calibration(argv[2], P, R, T)) return EXIT_FAILURE;
+    DetectionIndex detIndex;
+    if (!detIndex.load(drive_dir + "/image_02/BoxInfo.txt")) std::cerr << "Detection File doesn't exist." << std::endl;
+    const string bin_dir = drive_dir + "/velodyne_points/data/";
+    if (end < 0)
+        for (end = start; std::ifstream(bin_dir + frame_name(end + 1, "bin")).good(); end++);
+
+    // One ground model for the whole drive, it only ever sees the frames in order
+    GroundModel groundModel;
+    std::vector<StageTime> workerTime(threads);
+    StageTime total;
+    ObjectList carList(MAX_OBJECT_IN_LIST);
+    LinkList<detection_cam> detectPrev(MAX_DETECT_PER_FRAME);
+    size_t processed = 0, detections = 0;
+    auto run_start = batch_clock::now();
+
+    for (int first = start; first <= end; first += chunk) {
+        int count = std::min(chunk, end - first + 1);
+        std::vector<std::unique_ptr<BatchFrame>> frames(count);
+        parallel_for(count, threads, [&](const int t, const int k) {
+            frames[k].reset(new BatchFrame);
+            BatchFrame& frame = *frames[k];
+            frame.index = first + k;
+            auto stage_start = batch_clock::now();
+            if (!read_velodyne_file(bin_dir + frame_name(frame.index, "bin"), frame.bin))
+                std::cerr << "Couldn't read frame " << frame.index << std::endl;
+            workerTime[t].load += seconds_since(stage_start);
+            if (!use_ground_model) remove_ground(frame, nullptr, workerTime[t]);
+        });
+        // the temporal ground model depends on the previous frame, a thread per slice would change the result
+        if (use_ground_model)
+            for (int k = 0; k < count; k++) remove_ground(*frames[k], &groundModel, total);
+        parallel_for(count, threads, [&](const int t, const int k) {
+            BatchFrame& frame = *frames[k];
+            auto stage_start = batch_clock::now();
+            Boxes2d det_boxes, obj_boxes;
+            boxes_of_frame(detIndex, frame.index, det_boxes, obj_boxes);
+            detection_fusion detection;
+            detection.Initialize(frame.detectFrame, det_boxes, obj_boxes, frame.groundOffCloud, P, R, T);
+            if (detection.Is_initialized()) detection.extract_feature();
+            workerTime[t].fusion += seconds_since(stage_start);
+        });
+
+        // Tracking depends on the previous frame and runs in frame order
+        auto stage_start = batch_clock::now();
+        for (int k = 0; k < count; k++) {
+            LinkList<detection_cam>& detectCurr = frames[k]->detectFrame;
+            {
+                PROFILE_SCOPE(PROF_HUNGARIA);
+                Hungaria(detectPrev, detectCurr, &carList, TRACK_DEFAULT_DT, metric);
+            }
+            detectPrev = detectCurr;
+            detections += detectCurr.count();
+        }
+        total.tracking += seconds_since(stage_start);
+        processed += count;
+    }
+
+    double elapsed = seconds_since(run_start);
+    for (auto& w : workerTime) {
+        total.load += w.load;
+        total.ground += w.ground;
+        total.fusion += w.fusion;
+    }
+    printf("frames: %zu, detections: %zu, threads: %d, chunk: %d\n", processed, detections, threads, chunk);
+    printf("elapsed: %.3f s, %.2f frames/s\n", elapsed, elapsed > 0 ? processed / elapsed : 0.0);
+    if (processed)
+        printf("per frame (ms, summed over threads): load %.2f, ground %.2f, fusion %.2f, tracking %.2f\n",
+               1000 * total.load / processed, 1000 * total.ground / processed,
+               1000 * total.fusion / processed, 1000 * total.tracking / processed);
+    if (!profile_csv.empty() && !Profiler::instance().writeCsv(profile_csv))
+        std::cerr << "Cannot write profile to " << profile_csv << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -1,235 +1,498 @@
-#include "sensor_fusion/data_utils.hpp"
-#include "sensor_fusion/GroundRemove.h"
-#include "sensor_fusion/Tracking.h"
-#include <rclcpp/rclcpp.hpp>
+#include "sensor_fusion/sensor_fusion.h"
+#include <rclcpp_components/register_node_macro.hpp>
 
-
-//////////////////
-/// NODE CLASS ///
-//////////////////
-class SensorFusion : public rclcpp::Node {
-public:
-    SensorFusion();
-    ~SensorFusion(){};
-
-private:
-    ObjectList* ptrCarList;
-    LinkList<detection_cam>* ptrDetectFrame;
-    size_t callback_count;
-    struct calibration {
-        Matrix34d P;
-        Matrix3d R;
-        Matrix31d T;
-    };
-    calibration calib;
-
-    message_filters::Subscriber<sensor_msgs::msg::PointCloud2> pcl_sub;
-    message_filters::Subscriber<sensor_msgs::msg::Image> img_sub;
-    message_filters::Subscriber<darknet_ros_msgs::msg::BoundingBoxes> det_sub;
-    message_filters::Subscriber<darknet_ros_msgs::msg::BoundingBoxes> obj_sub;
-    //message_filters::Subscriber<sensor_msgs::msg::NavSatFix> gps_sub;
-    //message_filters::Subscriber<sensor_msgs::msg::Imu> imu_sub;
-
-    std::shared_ptr<Sync> sync_;
-    // Initialize publishers
-    rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pcl_pub_car;
-    rclcpp::Publisher<sensor_msgs::msg::PointCloud2>::SharedPtr pcl_pub;
-    rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr img_pub;
-    rclcpp::Publisher<visualization_msgs::msg::Marker>::SharedPtr box3d_pub;
-
-    string point_cloud_topic, image_topic, detect_box2d_topic, detect_obj2d_topic;
-    void sync_callback(const sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg, 
-                       const sensor_msgs::msg::Image::SharedPtr img_msg, 
-                       //const sensor_msgs::msg::Imu::SharedPtr imu_msg,
-                       //const sensor_msgs::msg::NavSatFix::SharedPtr gps_msg,
-                       const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr det_msg,
-                       const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr obj_msg);
-    bool get_calibration();
-};
 /*****************************************************
 *功能：传感器融合析构函数，初始化参数
 *****************************************************/
-SensorFusion::SensorFusion() : Node("sensor_fusion"),
-                               ptrCarList(new ObjectList(MAX_OBJECT_IN_LIST)),
-                               ptrDetectFrame(new LinkList<detection_cam>(MAX_DETECT_PER_FRAME)),
-                               callback_count(0) {
-    // Initial calibration parameters
-    get_calibration();
-
+SensorFusion::SensorFusion(const rclcpp::NodeOptions& options) : Node("sensor_fusion", options),
+                               callback_count(0),
+                               last_submitted_stamp(-1),
+                               camera_timeout((int64_t)CAMERA_TIMEOUT_MS * 1000000),
+                               restart_pending(false),
+                               running(true),
+                               dropped_frames(0) {
     // Initialize publisher
-    img_pub = this->create_publisher<sensor_msgs::msg::Image>("processed_img",10);
     pcl_pub_car = this->create_publisher<sensor_msgs::msg::PointCloud2>("processed_pcl",10);
     pcl_pub = this->create_publisher<sensor_msgs::msg::PointCloud2>("ground_free_cloud",10);
     box3d_pub = this->create_publisher<visualization_msgs::msg::Marker>("detection",10);
+    frame_done_pub = this->create_publisher<std_msgs::msg::Header>("frame_done",10);
 
-    // Initialize subscriber
+    // Initialize subscriber, every camera is synchronized with the shared point cloud subscriber
     this->declare_parameter<string>("point_cloud_topic", "/kitti_pub/kitti_points");
-    this->declare_parameter<string>("image_topic", "/kitti_pub/kitti_cam02");
-    this->declare_parameter<string>("detect_box2d_topic", "/kitti_pub/yolo_det_");
-    this->declare_parameter<string>("detect_obj2d_topic", "/kitti_pub/obj_det_");
     this->get_parameter_or<string>("point_cloud_topic", point_cloud_topic, "/kitti_pub/kitti_points");
-    this->get_parameter_or<string>("image_topic", image_topic, "/kitti_pub/kitti_cam02");
-    this->get_parameter_or<string>("detect_box2d_topic", detect_box2d_topic, "/kitti_pub/yolo_det");
-    this->get_parameter_or<string>("detect_obj2d_topic", detect_obj2d_topic, "/kitti_pub/obj_det");
+    this->declare_parameter<bool>("ground_model_cache", true);
+    this->get_parameter_or<bool>("ground_model_cache", use_ground_model, true);
+    // Preprocessed clouds are shared by stamp with co-located consumers, the cache keeps the largest request
+    int cloud_cache_size;
+    this->declare_parameter<int>("cloud_cache_size", CLOUD_CACHE_SIZE);
+    this->get_parameter_or<int>("cloud_cache_size", cloud_cache_size, CLOUD_CACHE_SIZE);
+    CloudCache::instance().reserve(std::max(cloud_cache_size, 0));
     pcl_sub.subscribe(this, point_cloud_topic);
-    img_sub.subscribe(this, image_topic);
-    det_sub.subscribe(this, detect_box2d_topic);
-    obj_sub.subscribe(this, detect_obj2d_topic);
+    init_cameras();
+    // Tracking association cost: iou_2d, bev_iou or center_distance
+    string metric_name;
+    this->declare_parameter<string>("association_metric", association_metric_name(ASSOC_IOU_2D));
+    this->get_parameter_or<string>("association_metric", metric_name, association_metric_name(ASSOC_IOU_2D));
+    if (!association_metric_from_name(metric_name, association_metric)) {
+        RCLCPP_WARN(this->get_logger(), "Unknown association metric %s, using %s.", metric_name.c_str(),
+                    association_metric_name(ASSOC_IOU_2D));
+        association_metric = ASSOC_IOU_2D;
+    }
 
-    // Initialize synchronizer
-    sync_.reset(new Sync(my_sync_policy(10), pcl_sub, img_sub,/* imu_sub, gps_sub, */det_sub, obj_sub));
-    sync_->registerCallback(&SensorFusion::sync_callback, this);
+    // Initialize result logger, result_logging can be toggled at runtime
+    string log_directory;
+    bool log_enabled;
+    this->declare_parameter<string>("result_log_directory", "log");
+    this->declare_parameter<bool>("result_logging", true);
+    this->get_parameter_or<string>("result_log_directory", log_directory, "log");
+    this->get_parameter_or<bool>("result_logging", log_enabled, true);
+    resultLogger.reset(new ResultLogger(log_directory));
+    resultLogger->setEnabled(log_enabled);
+    // Initialize profiling, the histograms are published on diagnostics and dumped to profile_csv on exit
+    bool profiling;
+    int profile_period_ms;
+    this->declare_parameter<bool>("profiling", false);
+    this->declare_parameter<int>("profile_period_ms", PROFILE_PERIOD_MS);
+    this->declare_parameter<string>("profile_csv", "");
+    this->get_parameter_or<bool>("profiling", profiling, false);
+    this->get_parameter_or<int>("profile_period_ms", profile_period_ms, PROFILE_PERIOD_MS);
+    this->get_parameter_or<string>("profile_csv", profile_csv, "");
+    Profiler::instance().setEnabled(profiling);
+    diagnostics_pub = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>("diagnostics", 10);
+    diagnostics_timer = this->create_wall_timer(std::chrono::milliseconds(std::max(profile_period_ms, 1)),
+                                                std::bind(&SensorFusion::publish_diagnostics, this));
+    this->set_on_parameters_set_callback(std::bind(&SensorFusion::on_parameters_set, this, std::placeholders::_1));
+
+    // Initialize pipeline stages
+    int queue_size;
+    this->declare_parameter<int>("pipeline_queue_size", PIPELINE_QUEUE_SIZE);
+    this->get_parameter_or<int>("pipeline_queue_size", queue_size, PIPELINE_QUEUE_SIZE);
+    queue_size = std::max(queue_size, 1);
+    ground_queue.reset(new FrameQueue(queue_size));
+    fusion_queue.reset(new FrameQueue(queue_size));
+    tracking_queue.reset(new FrameQueue(queue_size));
+    output_queue.reset(new FrameQueue(queue_size));
+    stage_threads.emplace_back(&SensorFusion::run_stage, this, ground_queue.get(), fusion_queue.get(), &SensorFusion::ground_stage);
+    stage_threads.emplace_back(&SensorFusion::run_stage, this, fusion_queue.get(), tracking_queue.get(), &SensorFusion::fusion_stage);
+    stage_threads.emplace_back(&SensorFusion::run_stage, this, tracking_queue.get(), output_queue.get(), &SensorFusion::tracking_stage);
+    stage_threads.emplace_back(&SensorFusion::run_stage, this, output_queue.get(), nullptr, &SensorFusion::output_stage);
+}
+/*****************************************************
+*功能：停止流水线线程
+*****************************************************/
+SensorFusion::~SensorFusion() {
+    running = false;
+    for (auto& t : stage_threads) if (t.joinable()) t.join();
+    if (!profile_csv.empty() && !Profiler::instance().writeCsv(profile_csv))
+        RCLCPP_WARN(this->get_logger(), "Cannot write profile to %s.", profile_csv.c_str());
 }
-bool SensorFusion::get_calibration() {
-    string input_file_name = "/home/kiki/data/kitti/calibration.txt";
-    std::ifstream input_file(input_file_name.c_str(), std::ifstream::in);
-    if(!input_file.is_open()) {std::cout << "Failed to open file. "  << std::endl; return false;}
-    // Reading parameters
-    string line;
-    for (int i = 0; i < 3; i++) {
-        std::stringstream iss;
-        string data_type;
-        getline(input_file, line);
-        iss << line;
-        iss >> data_type;
-        switch(data_type[0]) {
-            case 'P' :
-                for (int a = 0; a < 3; a++)
-                    for (int b = 0; b < 4; b++)
-                    iss >> calib.P(a,b);
-                break;
-            case 'R' :
-                for (int a = 0; a < 3; a++)
-                    for (int b = 0; b < 3; b++)
-                        iss >> calib.R(a,b);
-                break;
-            case 'T' :
-                iss >> calib.T[0];
-                iss >> calib.T[1];
-                iss >> calib.T[2];
-                break;
-            default : 
-                std::cout << "Invalid parameter." << std::endl;
-                return false;
+/*****************************************************
+*功能：发布各阶段耗时（微秒）与单帧计数的分位数统计
+*****************************************************/
+void SensorFusion::publish_diagnostics() {
+    if (!Profiler::instance().isEnabled()) return;
+    std::unique_ptr<diagnostic_msgs::msg::DiagnosticArray> msg(new diagnostic_msgs::msg::DiagnosticArray);
+    msg->header.stamp = this->now();
+    diagnostic_msgs::msg::DiagnosticStatus status;
+    status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+    status.name = string(this->get_name()) + ": pipeline";
+    status.hardware_id = "sensor_fusion";
+    status.message = std::to_string(callback_count) + " frames, " + std::to_string(dropped_frames) + " dropped";
+    size_t cache_hits, cache_misses;
+    CloudCache::instance().stats(cache_hits, cache_misses);
+    diagnostic_msgs::msg::KeyValue cache_kv;
+    cache_kv.key = "cloud_cache/hits";
+    cache_kv.value = std::to_string(cache_hits);
+    status.values.push_back(cache_kv);
+    cache_kv.key = "cloud_cache/misses";
+    cache_kv.value = std::to_string(cache_misses);
+    status.values.push_back(cache_kv);
+    for (const auto& stats : Profiler::instance().snapshot()) {
+        // latencies are reported in microseconds, counters as they are
+        double scale = stats.unit == "ns" ? 1e-3 : 1.0;
+        const char* suffix[4] = {"/p50", "/p99", "/max", "/count"};
+        double values[4] = {stats.p50 * scale, stats.p99 * scale, stats.max * scale, (double)stats.count};
+        for (int i = 0; i < 4; i++) {
+            diagnostic_msgs::msg::KeyValue kv;
+            kv.key = stats.name + suffix[i];
+            kv.value = std::to_string(values[i]);
+            status.values.push_back(kv);
         }
     }
-    input_file.close();
-    return true;
-    /*
-    std::stringstream iss;
-
-    getline(input_file, line);
-    iss << line;
-
-    std::cout << line << std::endl;
-
-    getline(input_file, line);
-    iss << line;
-    for (int a = 0; a < 3; a++)
-        for (int b = 0; b < 3; b++)
-            iss >> calib.R(a,b);
-    std::cout << line << std::endl;
+    msg->status.push_back(status);
+    diagnostics_pub->publish(std::move(msg));
+}
+/*****************************************************
+*功能：运行时参数修改回调，用于开关结果记录与性能统计
+*****************************************************/
+rcl_interfaces::msg::SetParametersResult SensorFusion::on_parameters_set(const std::vector<rclcpp::Parameter>& parameters) {
+    rcl_interfaces::msg::SetParametersResult result;
+    result.successful = true;
+    // reject the whole set before anything is applied, as_bool() throws on other types
+    for (const auto& parameter : parameters)
+        if ((parameter.get_name() == "result_logging" || parameter.get_name() == "profiling") &&
+            parameter.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
+            result.successful = false;
+            result.reason = parameter.get_name() + " must be a bool";
+            return result;
+        }
+    for (const auto& parameter : parameters)
+        if (parameter.get_name() == "result_logging") {
+            resultLogger->setEnabled(parameter.as_bool());
+            RCLCPP_INFO(this->get_logger(), "Result logging %s.", parameter.as_bool() ? "enabled" : "disabled");
+        } else if (parameter.get_name() == "profiling") {
+            Profiler::instance().setEnabled(parameter.as_bool());
+            RCLCPP_INFO(this->get_logger(), "Profiling %s.", parameter.as_bool() ? "enabled" : "disabled");
+        }
+    return result;
+}
+bool SensorFusion::get_calibration(const string& file_name, calibration& calib) {
+    return read_calibration(file_name, calib.P, calib.R, calib.T);
+}
+/*****************************************************
+*功能：按参数初始化各相机的订阅、同步器、标定与发布。参数：
+*cameras: 相机名称列表，默认只有cam02
+*camera_timeout_ms: 点云时间戳比最新点云早这么多时，不再等待未到达的相机
+*<相机名称>.image_topic/detect_box2d_topic/detect_obj2d_topic/calibration_file:
+*各相机的话题与标定文件，默认使用同名的顶层参数（单相机配置）
+*说明：
+*只有一个相机时处理后的图像发布在processed_img，否则发布在<相机名称>/processed_img。
+*各相机可以朝向任意方向，但都按KittiRig处理（1242x375的图像与相同的视锥近距离），
+*只支持与KITTI彩色相机几何相同的相机
+*****************************************************/
+void SensorFusion::init_cameras() {
+    string image_topic, detect_box2d_topic, detect_obj2d_topic, calibration_file;
+    std::vector<string> camera_names;
+    this->declare_parameter<string>("image_topic", "/kitti_pub/kitti_cam02");
+    this->declare_parameter<string>("detect_box2d_topic", "/kitti_pub/yolo_det");
+    this->declare_parameter<string>("detect_obj2d_topic", "/kitti_pub/obj_det");
+    this->declare_parameter<string>("calibration_file", DEFAULT_CALIBRATION_FILE);
+    this->declare_parameter<std::vector<string>>("cameras", std::vector<string>{"cam02"});
+    int camera_timeout_ms;
+    this->declare_parameter<int>("camera_timeout_ms", CAMERA_TIMEOUT_MS);
+    this->get_parameter_or<int>("camera_timeout_ms", camera_timeout_ms, CAMERA_TIMEOUT_MS);
+    camera_timeout = (int64_t)std::max(camera_timeout_ms, 0) * 1000000;
+    this->get_parameter_or<string>("image_topic", image_topic, "/kitti_pub/kitti_cam02");
+    this->get_parameter_or<string>("detect_box2d_topic", detect_box2d_topic, "/kitti_pub/yolo_det");
+    this->get_parameter_or<string>("detect_obj2d_topic", detect_obj2d_topic, "/kitti_pub/obj_det");
+    this->get_parameter_or<string>("calibration_file", calibration_file, DEFAULT_CALIBRATION_FILE);
+    this->get_parameter_or<std::vector<string>>("cameras", camera_names, std::vector<string>{"cam02"});
+    if (camera_names.empty()) camera_names.push_back("cam02");
 
-    getline(input_file, line);
-    iss << line;
-    iss >> calib.T[0];
-    iss >> calib.T[1];
-    iss >> calib.T[2];
-    std::cout << line << std::endl;
+    for (size_t c = 0; c < camera_names.size(); c++) {
+        std::unique_ptr<CameraStream> camera(new CameraStream(this, c));
+        camera->name = camera_names[c];
+        string cam_image_topic, cam_box2d_topic, cam_obj2d_topic, cam_calibration_file;
+        this->declare_parameter<string>(camera->name + ".image_topic", image_topic);
+        this->declare_parameter<string>(camera->name + ".detect_box2d_topic", detect_box2d_topic);
+        this->declare_parameter<string>(camera->name + ".detect_obj2d_topic", detect_obj2d_topic);
+        this->declare_parameter<string>(camera->name + ".calibration_file", calibration_file);
+        this->get_parameter_or<string>(camera->name + ".image_topic", cam_image_topic, image_topic);
+        this->get_parameter_or<string>(camera->name + ".detect_box2d_topic", cam_box2d_topic, detect_box2d_topic);
+        this->get_parameter_or<string>(camera->name + ".detect_obj2d_topic", cam_obj2d_topic, detect_obj2d_topic);
+        this->get_parameter_or<string>(camera->name + ".calibration_file", cam_calibration_file, calibration_file);
+        if (!get_calibration(cam_calibration_file, camera->calib))
+            RCLCPP_WARN(this->get_logger(), "No calibration for camera %s (%s).", camera->name.c_str(), cam_calibration_file.c_str());
 
-    std::cout << calib.P << std::endl << std::endl;
-    std::cout << calib.R << std::endl << std::endl;
-    std::cout << calib.T << std::endl << std::endl;
-*/
+        camera->img_sub.subscribe(this, cam_image_topic);
+        camera->det_sub.subscribe(this, cam_box2d_topic);
+        camera->obj_sub.subscribe(this, cam_obj2d_topic);
+        camera->sync_.reset(new Sync(my_sync_policy(10), pcl_sub, camera->img_sub,/* imu_sub, gps_sub, */camera->det_sub, camera->obj_sub));
+        camera->sync_->registerCallback(&CameraStream::sync_callback, camera.get());
+        camera->img_pub = this->create_publisher<sensor_msgs::msg::Image>(
+            camera_names.size() == 1 ? "processed_img" : camera->name + "/processed_img", 10);
+        cameras.push_back(std::move(camera));
+    }
+    fusion_workers.reset(new WorkerPool(cameras.size() - 1));
+}
+/*****************************************************
+*功能：单个相机的同步回调，交给节点按点云时间戳组装
+*****************************************************/
+void SensorFusion::CameraStream::sync_callback(const sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg,
+                                               const sensor_msgs::msg::Image::SharedPtr img_msg,
+                                               const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr det_msg,
+                                               const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr obj_msg) {
+    node->camera_callback(index, cloud_msg, img_msg, det_msg, obj_msg);
 }
 /*****************************************************
-*功能：回调函数，获得一帧多传感器数据后回调进行融合算法
+*功能：回调函数，按点云时间戳组装各相机的数据，所有相机到齐后送入流水线（ingest阶段）
 *输入：
+*camera: 相机序号
 *cloud_msg: 订阅的点云消息
 *img_msg: 订阅的图像消息
 *det_msg: 订阅的二维检测结果
+*obj_msg: 订阅的二维障碍物检测结果
+*说明：
+*帧按时间戳顺序送入流水线：一帧到齐时，更早的未到齐帧先以缺少部分相机的形式送出；
+*时间戳比当前点云早camera_timeout以上、或等待中的帧超过MAX_PENDING_FRAMES时，
+*最早的帧同样提前送出，之后到达的该帧数据被丢弃，从未送出的帧则直接发布frame_done。
+*时间戳倒退超过camera_timeout（如kitti_pub循环回放）时从头开始组装，见restart_sequence
 *****************************************************/
-void SensorFusion::sync_callback(const sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg, 
-                                 const sensor_msgs::msg::Image::SharedPtr img_msg, 
-                                 //const sensor_msgs::msg::Imu::SharedPtr imu_msg,
-                                 //const sensor_msgs::msg::NavSatFix::SharedPtr gps_msg,
-                                 const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr det_msg,
-                                 const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr obj_msg) {
-    // Data containers used
-    pcl::PointCloud<pcl::PointXYZI>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZI>);
-    pcl::PointCloud<pcl::PointXYZI>::Ptr segCloud (new pcl::PointCloud<pcl::PointXYZI>);
-
-    // Remove the points belonging to ground
-    pcl::fromROSMsg(*cloud_msg, *cloud);
-    GroundRemove groundOffCloud(cloud);
+void SensorFusion::camera_callback(const size_t camera,
+                                   const sensor_msgs::msg::PointCloud2::SharedPtr cloud_msg,
+                                   const sensor_msgs::msg::Image::SharedPtr img_msg,
+                                   const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr det_msg,
+                                   const darknet_ros_msgs::msg::BoundingBoxes::SharedPtr obj_msg) {
+    std::lock_guard<std::mutex> lock(assembly_mtx);
+    int64_t stamp = (int64_t)cloud_msg->header.stamp.sec * 1000000000 + cloud_msg->header.stamp.nanosec;
+    if (stamp <= last_submitted_stamp) {
+        if (last_submitted_stamp - stamp > camera_timeout) {
+            restart_sequence(stamp);
+        } else {
+            // late part of a frame that already went out, or of one that never will
+            if (std::find(handled_stamps.begin(), handled_stamps.end(), stamp) == handled_stamps.end()) {
+                frame_done_pub->publish(cloud_msg->header);
+                handled_stamps.push_back(stamp);
+                if (handled_stamps.size() > RECENT_STAMPS) handled_stamps.pop_front();
+            }
+            return;
+        }
+    }
+    FusionFramePtr& frame = pending_frames[stamp];
+    if (!frame) {
+        frame.reset(new FusionFrame(cameras.size()));
+        frame->ingest_time = std::chrono::steady_clock::now();
+        frame->cloud_msg = cloud_msg;
+    }
+    CameraFrame& camera_frame = frame->cameras[camera];
+    if (!camera_frame.received) frame->received_cameras++;
+    camera_frame.received = true;
+    camera_frame.img_msg = img_msg;
+    boxes_from_msg(*det_msg, camera_frame.det_boxes);
+    boxes_from_msg(*obj_msg, camera_frame.obj_boxes);
 
-    // Detection algorithm
-    LinkList<detection_cam> detectPrev = *ptrDetectFrame;
-    ptrDetectFrame->Reset();
-    detection_fusion detection;
-    detection.Initialize(*ptrDetectFrame, det_msg, obj_msg, groundOffCloud.ptrCloud, calib.P, calib.R, calib.T);
-    if (detection.Is_initialized()) detection.extract_feature();
+    if (frame->received_cameras == cameras.size()) {
+        // everything older than a complete frame goes out first, incomplete
+        while (pending_frames.begin()->first != stamp) {
+            submit_frame(pending_frames.begin()->second);
+            pending_frames.erase(pending_frames.begin());
+        }
+        submit_frame(frame);
+        last_submitted_stamp = stamp;
+        pending_frames.erase(pending_frames.begin());
+    }
+    // a camera that stopped publishing holds a frame only for camera_timeout of cloud time
+    while (!pending_frames.empty() && pending_frames.begin()->first < stamp - camera_timeout) {
+        last_submitted_stamp = pending_frames.begin()->first;
+        submit_frame(pending_frames.begin()->second);
+        pending_frames.erase(pending_frames.begin());
+    }
+    while (pending_frames.size() > MAX_PENDING_FRAMES) {
+        last_submitted_stamp = pending_frames.begin()->first;
+        submit_frame(pending_frames.begin()->second);
+        pending_frames.erase(pending_frames.begin());
+    }
+}
+/*****************************************************
+*功能：时间戳倒退时开始新的序列：等待中的帧（属于上一轮）以不完整的形式送出，
+*清空共享点云缓存中上一轮的同名时间戳，下一帧通知各阶段丢弃地面模型与跟踪状态
+*输入：
+*stamp: 新序列第一帧的点云时间戳，纳秒
+*****************************************************/
+void SensorFusion::restart_sequence(const int64_t stamp) {
+    RCLCPP_INFO(this->get_logger(), "Cloud stamps went back by %.3f s, starting a new sequence.",
+                (last_submitted_stamp - stamp) * 1e-9);
+    while (!pending_frames.empty()) {
+        submit_frame(pending_frames.begin()->second);
+        pending_frames.erase(pending_frames.begin());
+    }
+    last_submitted_stamp = -1;
+    handled_stamps.clear();
+    CloudCache::instance().clear();
+    restart_pending = true;
+}
+/*****************************************************
+*功能：将组装好的一帧送入流水线
+*说明：
+*流水线已满时丢弃当前帧，避免同步器队列积压
+*****************************************************/
+void SensorFusion::submit_frame(FusionFramePtr& frame) {
+    frame->index = callback_count;
+    const std_msgs::msg::Header& header = frame->cloud_msg->header;
+    handled_stamps.push_back((int64_t)header.stamp.sec * 1000000000 + header.stamp.nanosec);
+    if (handled_stamps.size() > RECENT_STAMPS) handled_stamps.pop_front();
+    frame->restart = restart_pending;
+    if (frame->received_cameras < cameras.size())
+        RCLCPP_DEBUG(this->get_logger(), "Frame %zu has %zu of %zu cameras.", callback_count,
+                     frame->received_cameras, cameras.size());
+    if (!ground_queue->push(frame)) {
+        dropped_frames++;
+        RCLCPP_WARN(this->get_logger(), "Pipeline is full, frame dropped (%zu in total).", dropped_frames);
+        frame_done_pub->publish(frame->cloud_msg->header);
+        return;
+    }
+    restart_pending = false;
+    callback_count++;
+}
+/*****************************************************
+*功能：流水线阶段线程，从输入队列取帧处理后送入下一阶段
+*输入：
+*in: 输入队列，本线程是唯一的消费者
+*out: 输出队列，本线程是唯一的生产者，为空表示最后一个阶段
+*process: 本阶段的处理函数
+*****************************************************/
+void SensorFusion::run_stage(FrameQueue* in, FrameQueue* out, void (SensorFusion::*process)(FusionFrame&)) {
+    const auto idle = std::chrono::microseconds(200);
+    FusionFramePtr frame;
+    while (running) {
+        if (!in->pop(frame)) {std::this_thread::sleep_for(idle); continue;}
+        (this->*process)(*frame);
+        // wait for the next stage instead of dropping, the bounded queues push back to ingest
+        while (out && running && !out->push(frame)) std::this_thread::sleep_for(idle);
+        frame.reset();
+    }
+}
+/*****************************************************
+*功能：地面去除阶段，直接读取点云消息缓冲区
+*****************************************************/
+void SensorFusion::ground_stage(FusionFrame& frame) {
+    if (frame.restart) groundModel.Reset();
+    // Reuse the ground-free cloud when another consumer in this process already preprocessed the frame
+    const std_msgs::msg::Header& header = frame.cloud_msg->header;
+    int64_t stamp = (int64_t)header.stamp.sec * 1000000000 + header.stamp.nanosec;
+    GroundMode ground_mode = use_ground_model ? GROUND_TEMPORAL : GROUND_PER_FRAME;
+    frame.preprocessed = CloudCache::instance().find(header.frame_id, stamp, ground_mode);
+    if (frame.preprocessed) {
+        frame.groundOffCloud = frame.preprocessed->groundOffCloud;
+        // the temporal model follows the frames it skipped
+        if (use_ground_model && frame.preprocessed->groundSectors) {
+            groundModel.sectors = *frame.preprocessed->groundSectors;
+            groundModel.cached_sectors = groundModel.sectors.size();
+            groundModel.segmented_sectors = 0;
+            groundModel.frame++;
+        }
+        PROFILE_COUNT(CNT_POINTS_GROUND_FREE, frame.groundOffCloud->points.size());
+        return;
+    }
 
-    // Tracking algorithm
-    Hungaria(detectPrev, *ptrDetectFrame, ptrCarList);
+    // Remove the points belonging to ground, reading the message buffer in place when possible
+    pcl::PointCloud<pcl::PointXYZI>::Ptr cloud (new pcl::PointCloud<pcl::PointXYZI>);
+    PointCloudView cloud_view;
+    if (!view_from_msg(*frame.cloud_msg, cloud_view)) {
+        PROFILE_SCOPE(PROF_FROM_ROS_MSG);
+        pcl::fromROSMsg(*frame.cloud_msg, *cloud);
+        cloud_view = PointCloudView(*cloud);
+    }
+    {
+        PROFILE_SCOPE(PROF_GROUND_REMOVE);
+        GroundRemove groundOffCloud(cloud_view, use_ground_model ? &groundModel : nullptr);
+        std::shared_ptr<const GroundSectors> ground_sectors;
+        if (use_ground_model) ground_sectors = std::make_shared<const GroundSectors>(groundModel.sectors);
+        frame.preprocessed = CloudCache::instance().insert(header.frame_id, stamp, ground_mode,
+                                                           groundOffCloud.ptrCloud, ground_sectors);
+        frame.groundOffCloud = frame.preprocessed->groundOffCloud;
+    }
+    PROFILE_COUNT(CNT_POINTS_IN, cloud_view.size());
+    PROFILE_COUNT(CNT_POINTS_GROUND_FREE, frame.groundOffCloud->points.size());
+}
+/*****************************************************
+*功能：视锥融合阶段，各相机在常驻的工作线程上并行提取每个二维检测对应的点云与三维检测框，
+*之后标记重叠视野中重复的检测
+*****************************************************/
+void SensorFusion::fusion_stage(FusionFrame& frame) {
+    auto fuse = [this, &frame](const size_t c) {
+        CameraFrame& camera_frame = frame.cameras[c];
+        if (!camera_frame.received) return;
+        const calibration& calib = cameras[c]->calib;
+        detection_fusion detection;
+        detection.Initialize(camera_frame.detectFrame, camera_frame.det_boxes, camera_frame.obj_boxes,
+                             *frame.preprocessed, calib.P, calib.R, calib.T);
+        if (detection.Is_initialized()) detection.extract_feature();
+        camera_frame.overlap_boxes = detection.get_boxes();
+    };
+    fusion_workers->run(frame.cameras.size(), fuse);
 
+    if (frame.cameras.size() > 1) {
+        std::vector<LinkList<detection_cam>*> camera_frames;
+        for (auto& camera_frame : frame.cameras) camera_frames.push_back(&camera_frame.detectFrame);
+        mark_cross_camera_duplicates(camera_frames, frame.groundOffCloud->points.size());
+    }
+    if (Profiler::instance().isEnabled()) {
+        size_t boxes = 0, clusters = 0;
+        for (auto& camera_frame : frame.cameras) {
+            boxes += camera_frame.det_boxes.size();
+            for (size_t j = 0; j < camera_frame.detectFrame.count(); j++)
+                if (!camera_frame.detectFrame.getPtrItem(j)->CarCloud.points.empty()) clusters++;
+        }
+        PROFILE_COUNT(CNT_BOXES, boxes);
+        PROFILE_COUNT(CNT_CLUSTERS, clusters);
+    }
+}
+/*****************************************************
+*功能：跟踪阶段，各相机分别与自己的上一帧检测结果匹配并更新物体列表与运动状态，
+*本帧缺少的相机保持原有轨迹
+*****************************************************/
+void SensorFusion::tracking_stage(FusionFrame& frame) {
+    // Tracking algorithm, detectPrev and carList of every camera are only touched by this stage
+    PROFILE_SCOPE(PROF_HUNGARIA);
+    const std_msgs::msg::Header& header = frame.cloud_msg->header;
+    int64_t stamp = (int64_t)header.stamp.sec * 1000000000 + header.stamp.nanosec;
+    if (frame.restart) {
+        // tracks of the previous sequence must not be associated across the jump
+        for (auto& camera : cameras) {
+            camera->detectPrev.Reset();
+            camera->carList.clear();
+            camera->prev_stamp = -1;
+        }
+    }
+    for (size_t c = 0; c < frame.cameras.size(); c++) {
+        CameraFrame& camera_frame = frame.cameras[c];
+        if (!camera_frame.received) continue;
+        CameraStream& camera = *cameras[c];
+        // tracks are predicted over the time since this camera's previous frame
+        float dt = camera.prev_stamp >= 0 && stamp > camera.prev_stamp ? (stamp - camera.prev_stamp) * 1e-9f : TRACK_DEFAULT_DT;
+        Hungaria(camera.detectPrev, camera_frame.detectFrame, &camera.carList, dt, association_metric);
+        camera.detectPrev = camera_frame.detectFrame;
+        camera.prev_stamp = stamp;
+    }
+}
+/*****************************************************
+*功能：输出阶段，记录分析数据，可视化并发布结果
+*****************************************************/
+void SensorFusion::output_stage(FusionFrame& frame) {
+    const std_msgs::msg::Header& header = frame.cloud_msg->header;
+    pcl::PointCloud<pcl::PointXYZI>::Ptr segCloud (new pcl::PointCloud<pcl::PointXYZI>);
 
-    // Store segmented point cloud into txt for later analysis
-    time_t now = time(0);
-    tm *ltm = localtime(&now);
-    char dir [100];
-    std::string directory ="";
-    sprintf(dir, "/home/kiki/project/KalmanFusion/ros_ws/src/sensor_fusion/%.4d_%.2d_%.1d/", 1900 + ltm->tm_year, 1 + ltm->tm_mon, ltm->tm_mday);
-    directory = dir;
-    for(size_t j = 0; j < ptrDetectFrame->count(); j++) {
-        detection_cam* ptr_detect = ptrDetectFrame->getPtrItem(j);
-        if (!ptr_detect->miss) {
-            string fruCloud_filename = directory + "frustum_cloud/" + std::to_string(callback_count) + "/" + std::to_string(j) + ".txt";
-            string surCloud_filename = directory + "surface_cloud/" + std::to_string(callback_count) + "/" + std::to_string(j) + ".txt";
-            string carCloud_filename = directory + "vehicle_cloud/" + std::to_string(callback_count) + "/" + std::to_string(j) + ".txt";
-            string filename = directory + "boxes/" + std::to_string(callback_count) + "/" + std::to_string(j) + ".txt";
-            std::ofstream fru_fout(fruCloud_filename.c_str(), std::ios::app);
-            std::ofstream sur_fout(surCloud_filename.c_str(), std::ios::app);
-            std::ofstream car_fout(carCloud_filename.c_str(), std::ios::app);
-            std::ofstream fout(filename.c_str(), std::ios::app);
-            fout << (ptr_detect->box.xmax+ptr_detect->box.xmin)/2 << '\t' << (ptr_detect->box.ymax+ptr_detect->box.ymin)/2 << '\t' << ptr_detect->box.xmax-ptr_detect->box.xmin << '\t' << ptr_detect->box.ymax-ptr_detect->box.ymin << std::endl;
-            for(auto it = ptr_detect->fruCloud.points.begin(); it != ptr_detect->fruCloud.points.end(); it++)
-                fru_fout << it->x << '\t' << it->y << '\t' << it->z << std::endl;
-            for(auto it = ptr_detect->surCloud.points.begin(); it != ptr_detect->surCloud.points.end(); it++)
-                sur_fout << it->x << '\t' << it->y << '\t' << it->z << std::endl;
-            for(auto it = ptr_detect->CarCloud.points.begin(); it != ptr_detect->CarCloud.points.end(); it++)
-                car_fout << it->x << '\t' << it->y << '\t' << it->z << std::endl;
-            fru_fout.close();
-            sur_fout.close();
-            car_fout.close();
-            fout.close();
+    // Store segmented point clouds for later analysis, written by the logger thread
+    {
+        PROFILE_SCOPE(PROF_RESULT_LOG);
+        int64_t stamp = (int64_t)header.stamp.sec * 1000000000 + header.stamp.nanosec;
+        if (frame.cameras.size() == 1) {
+            resultLogger->logFrame(frame.index, stamp, frame.cameras[0].detectFrame);
+        } else {
+            LinkList<detection_cam> detectAll(MAX_DETECT_PER_FRAME * frame.cameras.size());
+            for (auto& camera_frame : frame.cameras)
+                for (size_t j = 0; j < camera_frame.detectFrame.count(); j++)
+                    if (!camera_frame.detectFrame.getPtrItem(j)->duplicate)
+                        detectAll.addItem(*camera_frame.detectFrame.getPtrItem(j));
+            resultLogger->logFrame(frame.index, stamp, detectAll);
         }
     }
 
-    // Visualization of detection and tracking results
-    cv_bridge::CvImageConstPtr cv_ptr;
-    cv_ptr = cv_bridge::toCvCopy(img_msg, "bgr8");
-    Boxes2d overlap_boxes = detection.get_boxes();
-    for(auto it = overlap_boxes.begin(); it != overlap_boxes.end(); it++) draw_box(cv_ptr, *it, 0, -1);
-    for(size_t j = 0; j < ptrDetectFrame->count(); j++) {
-        detection_cam* ptr_detect = ptrDetectFrame->getPtrItem(j);
-        if (!ptr_detect->miss) {
-            draw_box(cv_ptr, ptr_detect->box, ptr_detect->id);
-            *segCloud += ptr_detect->CarCloud;
+    // Visualization of detection and tracking results, objects seen by several cameras are published once
+    PROFILE_SCOPE(PROF_DRAWING);
+    for (size_t c = 0; c < frame.cameras.size(); c++) {
+        CameraFrame& camera_frame = frame.cameras[c];
+        if (!camera_frame.received) continue;
+        LinkList<detection_cam>* ptrDetect = &camera_frame.detectFrame;
+        cv::Mat canvas;
+        std::unique_ptr<sensor_msgs::msg::Image> img_with_box = image_for_drawing(camera_frame.img_msg, canvas);
+        for(auto it = camera_frame.overlap_boxes.begin(); it != camera_frame.overlap_boxes.end(); it++) draw_box(canvas, *it, 0, -1);
+        for(size_t j = 0; j < ptrDetect->count(); j++) {
+            detection_cam* ptr_detect = ptrDetect->getPtrItem(j);
+            if (!ptr_detect->miss) draw_box(canvas, ptr_detect->box, ptr_detect->id);
+            if (ptr_detect->duplicate) continue;
+            if (!ptr_detect->miss) *segCloud += ptr_detect->CarCloud;
+            publish_3d_box(box3d_pub, ptr_detect->box3d, header, ptr_detect->id, ptr_detect->miss != 0);
         }
-        publish_3d_box(box3d_pub, ptr_detect->box3d, cloud_msg->header, ptr_detect->id, ptr_detect->miss != 0);
+        cameras[c]->img_pub->publish(std::move(img_with_box));
     }
-    publish_point_cloud(pcl_pub_car, segCloud, cloud_msg->header);
-    publish_point_cloud(pcl_pub, groundOffCloud.ptrCloud, cloud_msg->header);
-    sensor_msgs::msg::Image::SharedPtr img_with_box = cv_bridge::CvImage(img_msg->header, "bgr8", cv_ptr->image).toImageMsg();
-    img_pub->publish(*img_with_box);
-    callback_count++;
+    publish_point_cloud(pcl_pub_car, segCloud, header);
+    publish_point_cloud(pcl_pub, frame.groundOffCloud, header);
+    frame_done_pub->publish(header);
+    Profiler::instance().record(PROF_FRAME, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - frame.ingest_time).count());
 }
 
-int main(int argc, char **argv) {
-    rclcpp::init(argc, argv);
-    rclcpp::spin(std::make_shared<SensorFusion>());
-    //rclcpp::spin(n); // Create a default single-threaded executor and spin the specified node.
-    rclcpp::shutdown();
-    return 0;
-}
\ No newline at end of file
+// Register SensorFusion so that it can be loaded into a component container
+RCLCPP_COMPONENTS_REGISTER_NODE(SensorFusion)
@@ -0,0 +1,12 @@
+#include "sensor_fusion/sensor_fusion.h"
+
+int main(int argc, char **argv) {
+    rclcpp::init(argc, argv);
+    // Fusion stages run on their own threads; the executor only serves subscriptions and publishers
+    rclcpp::executors::MultiThreadedExecutor executor;
+    auto node = std::make_shared<SensorFusion>();
+    executor.add_node(node);
+    executor.spin();
+    rclcpp::shutdown();
+    return 0;
+}
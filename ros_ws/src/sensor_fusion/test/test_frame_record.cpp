@@ -0,0 +1,181 @@
+#include "sensor_fusion/FrameRecord.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+/*************************************************************************
+*文件名：test_frame_record.cpp
+*功能：FrameRecordWriter与FrameRecordReader的往返测试，包括未关闭文件的
+*索引重建以及截断、损坏记录的拒绝
+**************************************************************************/
+
+static pcl::PointCloud<pcl::PointXYZI> make_cloud(const size_t n, const float base) {
+    pcl::PointCloud<pcl::PointXYZI> cloud;
+    for (size_t i = 0; i < n; i++) {
+        pcl::PointXYZI point;
+        point.x = base + i;
+        point.y = base + i + 0.25f;
+        point.z = base + i + 0.5f;
+        point.intensity = 0;
+        cloud.points.push_back(point);
+    }
+    return cloud;
+}
+static detection_cam make_detection(const int id, const size_t points, const bool miss = false) {
+    detection_cam det;
+    det.id = id;
+    det.miss = miss;
+    det.box.xmin = 10; det.box.ymin = 20; det.box.xmax = 30; det.box.ymax = 60;
+    det.box3d.pos.x = id; det.box3d.pos.y = 2; det.box3d.pos.z = -1;
+    det.box3d.length = 4; det.box3d.width = 1.8; det.box3d.height = 1.5; det.box3d.heading = 0.5;
+    det.fruCloud = make_cloud(points, 100 * id);
+    det.surCloud = make_cloud(points + 1, 100 * id + 10);
+    det.CarCloud = make_cloud(points + 2, 100 * id + 20);
+    for (size_t i = 0; i < points + 2; i++) det.indices.indices.push_back(1000 * id + i);
+    return det;
+}
+static std::vector<char> make_frame(const uint64_t frame) {
+    LinkList<detection_cam> detections;
+    detections.addItem(make_detection(1, 3));
+    detections.addItem(make_detection(2, 0, true));
+    detections.addItem(make_detection(3, 5));
+    std::vector<char> buffer;
+    append_frame_record(buffer, frame, 1000 + frame, detections);
+    return buffer;
+}
+static std::vector<char> read_file(const std::string& path) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+static void write_file(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+}
+
+class FrameRecordTest : public ::testing::Test {
+protected:
+    std::string path;
+    void SetUp() override {path = "/tmp/test_frame_record_" + std::to_string(getpid()) + ".frec";}
+    void TearDown() override {std::remove(path.c_str());}
+    // writes frames [0, frames), the file is left open when writer is given
+    void writeFrames(FrameRecordWriter& writer, const uint64_t frames) {
+        ASSERT_TRUE(writer.open(path));
+        for (uint64_t f = 0; f < frames; f++) {
+            std::vector<char> buffer = make_frame(f);
+            ASSERT_EQ(writer.append(buffer.data(), buffer.size()), buffer.size());
+        }
+    }
+};
+
+static void expect_frame(const FrameRecordReader& reader, const size_t i) {
+    FrameView view;
+    ASSERT_TRUE(reader.getFrame(i, view));
+    EXPECT_EQ(view.header->frame, i);
+    EXPECT_EQ(view.header->stamp, (int64_t)(1000 + i));
+    // the missed detection is not logged
+    ASSERT_EQ(view.header->box_count, 2u);
+    EXPECT_EQ(view.boxes[0].id, 1);
+    EXPECT_EQ(view.boxes[1].id, 3);
+    EXPECT_EQ(view.boxes[1].slot, 2);
+    EXPECT_FLOAT_EQ(view.boxes[0].box2d[0], 20);
+    EXPECT_FLOAT_EQ(view.boxes[0].box2d[3], 40);
+    EXPECT_FLOAT_EQ(view.boxes[1].box3d[0], 3);
+    EXPECT_FLOAT_EQ(view.boxes[1].box3d[6], 0.5);
+    EXPECT_EQ(view.header->point_count, (3u + 4 + 5) + (5u + 6 + 7));
+
+    uint32_t count;
+    const float* cloud = view.cloud(1, FrameRecordReader::SURFACE, count);
+    ASSERT_EQ(count, 6u);
+    EXPECT_FLOAT_EQ(cloud[0], 310);
+    EXPECT_FLOAT_EQ(cloud[3 * 5 + 2], 315.5);
+    cloud = view.cloud(0, FrameRecordReader::VEHICLE, count);
+    ASSERT_EQ(count, 5u);
+    EXPECT_FLOAT_EQ(cloud[1], 120.25);
+    // indices of box 0 come first, then those of box 1
+    EXPECT_EQ(view.indices[0], 1000);
+    EXPECT_EQ(view.indices[5], 3000);
+    EXPECT_EQ(view.indices[5 + 6], 3006);
+}
+
+TEST_F(FrameRecordTest, RoundTrip) {
+    {
+        FrameRecordWriter writer;
+        writeFrames(writer, 3);
+    }
+    FrameRecordReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.count(), 3u);
+    for (size_t i = 0; i < reader.count(); i++) {
+        EXPECT_EQ(reader.entry(i).frame, i);
+        EXPECT_EQ(reader.entry(i).box_count, 2u);
+        expect_frame(reader, i);
+    }
+    FrameView view;
+    EXPECT_FALSE(reader.getFrame(3, view));
+}
+
+TEST_F(FrameRecordTest, RebuildIndexOfUnclosedFile) {
+    FrameRecordWriter writer;
+    writeFrames(writer, 2);
+    // the writer is still open, the file has no index table yet
+    FrameRecordReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.count(), 2u);
+    expect_frame(reader, 0);
+    expect_frame(reader, 1);
+}
+
+TEST_F(FrameRecordTest, RebuildIndexIgnoresTruncatedRecord) {
+    std::vector<char> bytes;
+    {
+        FrameRecordWriter writer;
+        writeFrames(writer, 2);
+        bytes = read_file(path);
+    }
+    // a crash in the middle of the third record
+    std::vector<char> third = make_frame(2);
+    bytes.insert(bytes.end(), third.begin(), third.begin() + third.size() / 2);
+    write_file(path, bytes);
+
+    FrameRecordReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.count(), 2u);
+    expect_frame(reader, 1);
+}
+
+TEST_F(FrameRecordTest, RejectsCorruptCounts) {
+    {
+        FrameRecordWriter writer;
+        writeFrames(writer, 2);
+    }
+    std::vector<char> bytes = read_file(path);
+    std::vector<char> frame = make_frame(0);
+    size_t second = sizeof(FrameFileHeader) + frame.size();
+    // box count of frame 0 and point count of a box in frame 1 point past their records
+    FrameRecordHeader header;
+    std::memcpy(&header, &bytes[sizeof(FrameFileHeader)], sizeof(header));
+    header.box_count = 1000000;
+    std::memcpy(&bytes[sizeof(FrameFileHeader)], &header, sizeof(header));
+    BoxRecord box;
+    size_t box_offset = second + sizeof(FrameRecordHeader);
+    std::memcpy(&box, &bytes[box_offset], sizeof(box));
+    box.fru_count = 0xffffffffu;
+    std::memcpy(&bytes[box_offset], &box, sizeof(box));
+    write_file(path, bytes);
+
+    FrameRecordReader reader;
+    ASSERT_TRUE(reader.open(path));
+    ASSERT_EQ(reader.count(), 2u);
+    FrameView view;
+    EXPECT_FALSE(reader.getFrame(0, view));
+    EXPECT_FALSE(reader.getFrame(1, view));
+}
+
+TEST_F(FrameRecordTest, RejectsForeignFile) {
+    write_file(path, std::vector<char>(sizeof(FrameFileHeader), 'x'));
+    FrameRecordReader reader;
+    EXPECT_FALSE(reader.open(path));
+}